@@ -0,0 +1,249 @@
+#!/bin/bash
+
+# Performance regression suite for the pseudo-shell.
+#
+# test_script.sh checks correctness; this script only measures speed.
+# It builds large inputs (a 1 GiB file, a 100k-entry directory and a
+# 100k-command script), times ls/cp/mv/cat/rm and script execution,
+# writes the timings to a JSON file and compares them against a stored
+# baseline. The run fails if any benchmark got slower than the threshold.
+#
+# Usage: ./bench_script.sh [--update-baseline]
+#
+# Environment:
+#   BENCH_SCALE      divide every size by this (default 1, use 10 or 100 for a quick run)
+#   BENCH_RUNS       runs per benchmark, the fastest one is kept (default 3)
+#   BENCH_THRESHOLD  allowed slowdown in percent (default 20)
+#   BENCH_MIN_DELTA  slowdowns below this many ms are treated as noise (default 25)
+#   BENCH_BASELINE   baseline file (default bench_baseline.json)
+#   BENCH_RESULTS    results file (default bench_results.json)
+#
+# NOTE: the baseline is machine specific, it is created on the first run
+# (or with --update-baseline) and is not meant to be committed.
+
+EXECUTABLE="./pseudo-shell"
+
+BENCH_DIR="bench_pseudo_shell"
+
+SCALE=${BENCH_SCALE:-1}
+RUNS=${BENCH_RUNS:-3}
+THRESHOLD=${BENCH_THRESHOLD:-20}
+MIN_DELTA=${BENCH_MIN_DELTA:-25}
+BASELINE=${BENCH_BASELINE:-bench_baseline.json}
+RESULTS=${BENCH_RESULTS:-bench_results.json}
+
+BIG_FILE_MB=$((1024 / SCALE))
+NUM_ENTRIES=$((100000 / SCALE))
+NUM_COMMANDS=$((100000 / SCALE))
+
+# name -> fastest time in ms, in the order the benchmarks ran
+BENCH_NAMES=()
+declare -A BENCH_MS
+
+
+#---------------------------
+# Helpers
+
+now_ns() {
+    date +%s%N
+}
+
+# run_timed <name> <setup function> <command string>
+# runs setup (untimed) then the command RUNS times, keeps the fastest run
+run_timed() {
+    local name="$1"
+    local setup="$2"
+    local command="$3"
+    local best=""
+
+    for ((run = 0; run < RUNS; run++)); do
+        $setup
+        local start=$(now_ns)
+        eval "$command" > /dev/null 2>&1
+        local end=$(now_ns)
+        local ms=$(( (end - start) / 1000000 ))
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+
+    BENCH_NAMES+=("$name")
+    BENCH_MS[$name]=$best
+    printf "  %-20s %8d ms\n" "$name" "$best"
+}
+
+# feed one command to the interactive shell, stdout goes to /dev/null
+shell_cmd() {
+    printf '%s\nexit\n' "$1" | ../$EXECUTABLE
+}
+
+# look up a value in one of our flat JSON files
+json_value() {
+    local file="$1"
+    local key="$2"
+    grep "\"$key\"" "$file" 2>/dev/null | head -1 | sed 's/.*: *\([0-9]*\).*/\1/'
+}
+
+
+#---------------------------
+# Setup functions (not timed)
+
+setup_bench_environment() {
+    rm -drf $BENCH_DIR
+    mkdir $BENCH_DIR
+    cd $BENCH_DIR
+
+    echo "Creating ${BIG_FILE_MB} MiB file..."
+    dd if=/dev/urandom of=big.bin bs=1M count=$BIG_FILE_MB status=none
+
+    echo "Creating directory with $NUM_ENTRIES entries..."
+    mkdir many
+    (cd many && seq -f "f_%06g" 1 $NUM_ENTRIES | xargs touch)
+
+    echo "Creating $NUM_COMMANDS-command script..."
+    for ((i = 0; i < NUM_COMMANDS / 4; i++)); do
+        echo "pwd ; cd . ; mkdir d ; rm missing"
+    done > script.txt
+
+    cd ..
+}
+
+cleanup_bench_environment() {
+    rm -drf $BENCH_DIR
+}
+
+setup_none() {
+    :
+}
+
+setup_cp() {
+    rm -f big_copy.bin
+}
+
+setup_mv() {
+    if [ -f big_moved.bin ]; then
+        mv big_moved.bin big.bin
+    fi
+}
+
+setup_rm_files() {
+    rm -drf rm_dir
+    mkdir rm_dir
+    (cd rm_dir && seq -f "f_%06g" 1 $NUM_ENTRIES | xargs touch)
+}
+
+setup_rm_lines() {
+    setup_rm_files
+    seq -f "rm rm_dir/f_%06g" 1 $NUM_ENTRIES > rm_script.txt
+}
+
+setup_plan() {
+    ../$EXECUTABLE --compile script.txt script.plan
+}
+
+
+#---------------------------
+# Benchmarks
+
+run_benchmarks() {
+    cd $BENCH_DIR
+
+    echo "=== Running benchmarks (scale 1/$SCALE, best of $RUNS) ==="
+    run_timed "cat_big_file" setup_none "shell_cmd 'cat big.bin'"
+    run_timed "cp_big_file" setup_cp "shell_cmd 'cp big.bin big_copy.bin'"
+    run_timed "mv_big_file" setup_mv "shell_cmd 'mv big.bin big_moved.bin'"
+    setup_mv
+    run_timed "ls_many_entries" setup_none "shell_cmd 'cd many ; ls'"
+    run_timed "rm_glob_entries" setup_rm_files "shell_cmd 'rm rm_dir/f_*'"
+    run_timed "rm_one_per_line" setup_rm_lines "../$EXECUTABLE -f rm_script.txt"
+    run_timed "script_commands" setup_none "../$EXECUTABLE -f script.txt"
+    run_timed "plan_commands" setup_plan "../$EXECUTABLE --run-plan script.plan"
+
+    cd ..
+}
+
+
+#---------------------------
+# Results
+
+write_results() {
+    {
+        echo "{"
+        echo "  \"scale\": $SCALE,"
+        local count=${#BENCH_NAMES[@]}
+        for ((i = 0; i < count; i++)); do
+            local name=${BENCH_NAMES[$i]}
+            local comma=","
+            if [ $i -eq $((count - 1)) ]; then comma=""; fi
+            echo "  \"$name\": ${BENCH_MS[$name]}$comma"
+        done
+        echo "}"
+    } > "$RESULTS"
+    echo "Results written to $RESULTS"
+}
+
+# returns 1 if anything regressed
+compare_with_baseline() {
+    if [ ! -f "$BASELINE" ]; then
+        cp "$RESULTS" "$BASELINE"
+        echo "No baseline found: saved this run as $BASELINE"
+        return 0
+    fi
+
+    local baseline_scale=$(json_value "$BASELINE" scale)
+    if [ "$baseline_scale" != "$SCALE" ]; then
+        echo "ERROR: baseline was recorded at scale $baseline_scale, this run used $SCALE."
+        echo "Re-run with BENCH_SCALE=$baseline_scale or use --update-baseline."
+        return 1
+    fi
+
+    echo "=== Comparing with $BASELINE (threshold ${THRESHOLD}%) ==="
+    local failed=0
+    for name in "${BENCH_NAMES[@]}"; do
+        local old=$(json_value "$BASELINE" "$name")
+        local new=${BENCH_MS[$name]}
+        if [ -z "$old" ]; then
+            printf "  %-20s %8d ms  (new, no baseline)\n" "$name" "$new"
+            continue
+        fi
+
+        local limit=$(( old + old * THRESHOLD / 100 ))
+        if [ "$new" -gt "$limit" ] && [ $((new - old)) -gt "$MIN_DELTA" ]; then
+            printf "  %-20s %8d ms  was %d ms  REGRESSION\n" "$name" "$new" "$old"
+            failed=1
+        else
+            printf "  %-20s %8d ms  was %d ms  ok\n" "$name" "$new" "$old"
+        fi
+    done
+
+    if [ $failed -ne 0 ]; then
+        echo "ERROR: performance regression detected."
+        return 1
+    fi
+    echo "No regressions."
+    return 0
+}
+
+
+#---------------------------
+
+make
+if [ ! -f "$EXECUTABLE" ]; then
+    echo "Error: Compilation failed, executable not found."
+    exit 1
+fi
+
+setup_bench_environment
+run_benchmarks
+cleanup_bench_environment
+
+write_results
+
+if [ "$1" == "--update-baseline" ]; then
+    cp "$RESULTS" "$BASELINE"
+    echo "Baseline updated."
+    exit 0
+fi
+
+compare_with_baseline
+exit $?
@@ -0,0 +1,833 @@
+//Purpose: 
+//implement commands for the shell as specified in the project instructions
+
+//instructions: 
+//no printf or fopen
+//use write() instead
+//using low-level system calls
+
+#define _GNU_SOURCE
+#include "command.h"
+#include "tree_walk.h"
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <libgen.h>
+#include <fnmatch.h>
+
+//ls | system call --> opendir(), readdir(), closedir()
+void listDir() {
+    //pass in "." as current directory
+    DIR* dir = opendir(".");
+
+    //error: null is returned
+    if (dir == NULL) {
+        char* exist_msg = "Directory does not exist\n";
+        write(1, exist_msg, strlen(exist_msg));
+        return;
+        }
+
+    //declare entry variable
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        int len = strlen(entry->d_name);
+        write(1, entry->d_name, len);
+        write(1, " ", 1);
+    }
+    write(1, "\n", 1);
+    closedir(dir);
+}
+
+
+//pwd | system call --> getcwd
+void showCurrentDir() {
+    //allocate a buffer on the stack
+    char path_buffer[1024];
+
+    //getcwd() asks kernal for CWD
+    //puts it into the buffer
+    if (getcwd(path_buffer, sizeof(path_buffer)) != NULL) {
+        //successful: write path to stdout (fd 1)
+        write(1, path_buffer, strlen(path_buffer));
+        //newline
+        write(1, "\n", 1);
+    } else {
+        //error: write error message to stderr (fd 2)
+        char* error_msg = "Error: Could not get current directory\n";
+        write(2, error_msg, strlen(error_msg));
+    }
+}
+
+
+//mkdir | system call --> mkdir()
+void makeDir(char *dirName) {
+    //0755 provides r/w/execute for owner
+    //and read/execute for group and others
+    int status = mkdir(dirName, 0755);
+
+    //error when return -1:
+    if (status == -1) {
+        switch (errno) {
+            //how to handle if directory exists already
+            case EEXIST:
+                char* exist_msg = "Directory already exists!\n";
+                write(2, exist_msg, strlen(exist_msg));
+                break;
+            default: 
+                char* error_msg = "Error: Could not make directory\n";
+                write(2, error_msg, strlen(error_msg));
+                break;
+        }
+    }
+    //if successful: nothing because no output
+}
+
+
+//cd | system call --> chdir()
+void changeDir(char *dirName) {
+    int status = chdir(dirName);
+
+    //error when -1 is returned
+    if (status == -1) {
+        char* error_msg = "Error: Directory not found\n";
+        write(2, error_msg, strlen(error_msg));
+    }
+    //if successful: nothing because no output
+}
+
+
+//cp | system call --> open() *  2, read(), write(), close() * 2
+void copyFile(char *sourcePath, char *destinationPath) {
+    int src_fd, dst_fd;
+    ssize_t bytes_read;
+    char buffer[1024];
+    struct stat stat_buf;
+    //buffer for final path
+    char final_dst_path[1024];
+
+    //check if dst is directory
+    int stat_result = stat(destinationPath, &stat_buf);
+    if (stat_result == 0 && S_ISDIR(stat_buf.st_mode)){
+        //if dst is directory
+        //need non-const copy of sourcePath for basename()
+        char* src_path_copy = strdup(sourcePath);
+        char* src_basename = basename(src_path_copy);
+
+        //build new path
+        strcpy(final_dst_path, destinationPath);
+        strcat(final_dst_path, "/");
+        strcat(final_dst_path, src_basename);
+
+        //free strdup
+        free(src_path_copy);
+    } else {
+        //dst is a file
+        strcpy(final_dst_path, destinationPath);
+    }
+
+    //open the src file and read from it
+    src_fd = open(sourcePath, O_RDONLY);
+    //error when -1 is returned
+    if (src_fd < 0) {
+        char* error_msg = "Error: Cannot open source file\n";
+        write(2, error_msg, strlen(error_msg));
+        return;
+    }
+
+    //open the destination file
+    dst_fd = open(final_dst_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    //error when -1
+    if (dst_fd < 0) {
+        char* error_msg = "Error: Cannot open destination file\n";
+        write(2, error_msg, strlen(error_msg));
+        //close source file before returning to prevent mem leaks
+        close(src_fd);
+        return;
+    }
+
+    //read-write loop
+    //return number of bytes read
+    while ((bytes_read = read(src_fd, buffer, sizeof(buffer))) > 0) {
+        //write() exact number of bytes read
+        ssize_t bytes_written = write(dst_fd, buffer, bytes_read);
+
+        //check if write failed
+        if (bytes_written != bytes_read) {
+            char* error_msg = "Error: Failed to write to destination file\n";
+            write(2, error_msg, strlen(error_msg));
+            break;
+        }
+    }
+
+    //close both file descriptors
+    close(src_fd);
+    close(dst_fd);
+}
+
+
+//mv | system call --> reuse functions --> copyFile(sp, dp), deleteFile(sp)
+void moveFile(char *sourcePath, char *destinationPath) {
+    copyFile(sourcePath, destinationPath);
+    deleteFile(sourcePath);
+}
+
+
+//rm | system call --> unlink()
+void deleteFile(char *filename) {
+    if (unlink(filename) == -1) {
+        char* error_msg = "File not found\n";
+        write(2, error_msg, strlen(error_msg));
+    }
+    //successful: no output
+}
+
+
+//cat | system calls --> open(), read(), write(), close()
+void displayFile(char *filename) {
+    //open file and read only
+    int fd = open(filename, O_RDONLY);
+    //error if less than 0
+    if (fd < 0) {
+        char* error_msg = "Error: Cannot open file\n";
+        write(2, error_msg, strlen(error_msg));
+        //stop the function
+        return;
+    }
+
+    //prepare buffer for read-write loop
+    char buffer[1024];
+    ssize_t bytes_read;
+
+    //start the loop
+    //read() to fill the buffer and return # of bytes read
+    //returns 0 when hits end of file
+    //returns -1 on error
+    while ((bytes_read = read(fd, buffer, sizeof(buffer))) > 0) {
+        //write bytes read to stdout
+        write(1, buffer, bytes_read);
+    }
+
+    //close file descriptor
+    close(fd);
+}
+
+// ------------------------------ Batched rm / cp ------------------------------
+//operands are grouped by parent directory: the directory is opened once and
+//every unlink/open goes through unlinkat()/openat() relative to that dirfd,
+//so the kernel does not re-walk the full path for each operand.
+//* and ? in the last path component are expanded with one readdir() pass.
+
+//one open directory, reused while consecutive operands share it
+typedef struct {
+    int fd;
+    char path[1024];
+} dir_handle;
+
+//one operand split into parent directory and last component
+typedef struct {
+    int index;
+    const char *name;
+    char dir[1024];
+} operand;
+
+//true if the name needs glob expansion
+static int has_glob(const char *name) {
+    return strpbrk(name, "*?") != NULL;
+}
+
+//split path into parent directory and last component
+//"a/b.txt" -> "a" + "b.txt" | "b.txt" -> "." + "b.txt" | "/b.txt" -> "/" + "b.txt"
+static const char* split_path(const char *path, char *dir_out, size_t dir_size) {
+    const char *slash = strrchr(path, '/');
+    if (slash == NULL) {
+        strcpy(dir_out, ".");
+        return path;
+    }
+
+    size_t len = slash - path;
+    //keep the slash for the root directory
+    if (len == 0) len = 1;
+    if (len >= dir_size) len = dir_size - 1;
+    memcpy(dir_out, path, len);
+    dir_out[len] = '\0';
+    return slash + 1;
+}
+
+//return a dirfd for dir, only calling open() when the directory changes
+static int dir_handle_get(dir_handle *handle, const char *dir) {
+    if (handle->fd >= 0 && strcmp(handle->path, dir) == 0) {
+        return handle->fd;
+    }
+    if (handle->fd >= 0) {
+        close(handle->fd);
+    }
+
+    handle->fd = open(dir, O_RDONLY | O_DIRECTORY);
+    strncpy(handle->path, dir, sizeof(handle->path) - 1);
+    handle->path[sizeof(handle->path) - 1] = '\0';
+    return handle->fd;
+}
+
+//by parent directory, then in the order they were given
+static int operand_compare(const void *a, const void *b) {
+    const operand *x = a;
+    const operand *y = b;
+    int cmp = strcmp(x->dir, y->dir);
+    if (cmp != 0) return cmp;
+    return x->index - y->index;
+}
+
+//split every path and sort the operands by parent directory, so each
+//directory is opened once however the operands were ordered
+//returns NULL when out of memory
+static operand* group_operands(char **paths, int count) {
+    operand *ops = malloc(count * sizeof(operand));
+    if (ops == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        ops[i].index = i;
+        ops[i].name = split_path(paths[i], ops[i].dir, sizeof(ops[i].dir));
+    }
+    qsort(ops, count, sizeof(operand), operand_compare);
+    return ops;
+}
+
+//glob_scan() failed: say why
+static void glob_error(void) {
+    char* error_msg = errno == ENOMEM ? "Error: Out of memory\n" : "Error: Cannot read directory\n";
+    write(2, error_msg, strlen(error_msg));
+}
+
+//free the name list built by glob_scan()
+static void free_matches(char **matches, int count) {
+    for (int i = 0; i < count; i++) {
+        free(matches[i]);
+    }
+    free(matches);
+}
+
+//read the directory once and collect every entry matching pattern
+//names are collected first so unlinking them cannot disturb the scan
+//returns the number of matches, -1 on error (errno says why)
+static int glob_scan(int dirfd, const char *pattern, char ***matches) {
+    *matches = NULL;
+
+    //fdopendir() takes ownership of its fd, so give it a copy
+    int scan_fd = dup(dirfd);
+    if (scan_fd < 0) {
+        return -1;
+    }
+    DIR* dir = fdopendir(scan_fd);
+    if (dir == NULL) {
+        close(scan_fd);
+        return -1;
+    }
+    //the copy shares its offset with dirfd, start from the top
+    rewinddir(dir);
+
+    int count = 0;
+    int capacity = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        //FNM_PERIOD: * and ? do not match a leading dot, like a real shell
+        if (fnmatch(pattern, entry->d_name, FNM_PERIOD) != 0) {
+            continue;
+        }
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            char **grown = realloc(*matches, capacity * sizeof(char*));
+            if (grown == NULL) {
+                free_matches(*matches, count);
+                *matches = NULL;
+                closedir(dir);
+                errno = ENOMEM;
+                return -1;
+            }
+            *matches = grown;
+        }
+        char *name = strdup(entry->d_name);
+        if (name == NULL) {
+            free_matches(*matches, count);
+            *matches = NULL;
+            closedir(dir);
+            errno = ENOMEM;
+            return -1;
+        }
+        (*matches)[count++] = name;
+    }
+
+    closedir(dir);
+    return count;
+}
+
+//copy src_name (relative to src_dirfd) to dst_name (relative to dst_dirfd)
+static void copy_at(int src_dirfd, const char *src_name, int dst_dirfd, const char *dst_name) {
+    struct stat src_stat, dst_stat;
+
+    int src_fd = openat(src_dirfd, src_name, O_RDONLY);
+    if (src_fd < 0) {
+        char* error_msg = "Error: Cannot open source file\n";
+        write(2, error_msg, strlen(error_msg));
+        return;
+    }
+    if (fstat(src_fd, &src_stat) != 0) {
+        char* error_msg = "Error: Cannot open source file\n";
+        write(2, error_msg, strlen(error_msg));
+        close(src_fd);
+        return;
+    }
+    if (S_ISDIR(src_stat.st_mode)) {
+        char* error_msg = "Error: Cannot copy a directory\n";
+        write(2, error_msg, strlen(error_msg));
+        close(src_fd);
+        return;
+    }
+
+    //no O_TRUNC yet: copying a file onto itself must not wipe it first
+    //a new file gets the source's permission bits (less the umask)
+    int dst_fd = openat(dst_dirfd, dst_name, O_WRONLY | O_CREAT, src_stat.st_mode & 07777);
+    if (dst_fd < 0) {
+        char* error_msg = "Error: Cannot open destination file\n";
+        write(2, error_msg, strlen(error_msg));
+        close(src_fd);
+        return;
+    }
+    if (fstat(dst_fd, &dst_stat) == 0 &&
+        dst_stat.st_dev == src_stat.st_dev && dst_stat.st_ino == src_stat.st_ino) {
+        char* error_msg = "Error: Source and destination are the same file\n";
+        write(2, error_msg, strlen(error_msg));
+        close(src_fd);
+        close(dst_fd);
+        return;
+    }
+    if (ftruncate(dst_fd, 0) == -1) {
+        char* error_msg = "Error: Cannot truncate destination file\n";
+        write(2, error_msg, strlen(error_msg));
+        close(src_fd);
+        close(dst_fd);
+        return;
+    }
+
+    char buffer[4096];
+    ssize_t bytes_read;
+    while ((bytes_read = read(src_fd, buffer, sizeof(buffer))) > 0) {
+        if (write(dst_fd, buffer, bytes_read) != bytes_read) {
+            char* error_msg = "Error: Failed to write to destination file\n";
+            write(2, error_msg, strlen(error_msg));
+            break;
+        }
+    }
+
+    close(src_fd);
+    close(dst_fd);
+}
+
+
+//rm f1 f2 ... | system call --> unlinkat()
+void deleteFiles(char **paths, int count) {
+    operand *ops = group_operands(paths, count);
+    if (ops == NULL) {
+        char* error_msg = "Error: Out of memory\n";
+        write(2, error_msg, strlen(error_msg));
+        return;
+    }
+    dir_handle dir = { -1, "" };
+
+    for (int i = 0; i < count; i++) {
+        const char *name = ops[i].name;
+        int dirfd = dir_handle_get(&dir, ops[i].dir);
+        if (dirfd < 0 || name[0] == '\0') {
+            char* error_msg = "File not found\n";
+            write(2, error_msg, strlen(error_msg));
+            continue;
+        }
+
+        if (!has_glob(name)) {
+            if (unlinkat(dirfd, name, 0) == -1) {
+                char* error_msg = "File not found\n";
+                write(2, error_msg, strlen(error_msg));
+            }
+            continue;
+        }
+
+        char **matches;
+        int num_matches = glob_scan(dirfd, name, &matches);
+        if (num_matches < 0) {
+            glob_error();
+            continue;
+        }
+        if (num_matches == 0) {
+            char* error_msg = "Error: No files match pattern\n";
+            write(2, error_msg, strlen(error_msg));
+            continue;
+        }
+        for (int j = 0; j < num_matches; j++) {
+            if (unlinkat(dirfd, matches[j], 0) == -1) {
+                char* error_msg = "Error: Cannot remove file\n";
+                write(2, error_msg, strlen(error_msg));
+            }
+        }
+        free_matches(matches, num_matches);
+    }
+
+    if (dir.fd >= 0) {
+        close(dir.fd);
+    }
+    free(ops);
+}
+
+
+//cp f1 f2 ... dir | system call --> openat() * 2, read(), write(), close() * 2
+void copyFiles(char **sourcePaths, int count, char *destinationDir) {
+    //every copy lands in the same directory: open it once
+    int dst_dirfd = open(destinationDir, O_RDONLY | O_DIRECTORY);
+    if (dst_dirfd < 0) {
+        char* error_msg = "Error: Destination is not a directory\n";
+        write(2, error_msg, strlen(error_msg));
+        return;
+    }
+
+    operand *ops = group_operands(sourcePaths, count);
+    if (ops == NULL) {
+        char* error_msg = "Error: Out of memory\n";
+        write(2, error_msg, strlen(error_msg));
+        close(dst_dirfd);
+        return;
+    }
+    dir_handle dir = { -1, "" };
+
+    for (int i = 0; i < count; i++) {
+        const char *name = ops[i].name;
+        int src_dirfd = dir_handle_get(&dir, ops[i].dir);
+        if (src_dirfd < 0 || name[0] == '\0') {
+            char* error_msg = "Error: Cannot open source file\n";
+            write(2, error_msg, strlen(error_msg));
+            continue;
+        }
+
+        if (!has_glob(name)) {
+            copy_at(src_dirfd, name, dst_dirfd, name);
+            continue;
+        }
+
+        char **matches;
+        int num_matches = glob_scan(src_dirfd, name, &matches);
+        if (num_matches < 0) {
+            glob_error();
+            continue;
+        }
+        if (num_matches == 0) {
+            char* error_msg = "Error: No files match pattern\n";
+            write(2, error_msg, strlen(error_msg));
+            continue;
+        }
+        for (int j = 0; j < num_matches; j++) {
+            copy_at(src_dirfd, matches[j], dst_dirfd, matches[j]);
+        }
+        free_matches(matches, num_matches);
+    }
+
+    if (dir.fd >= 0) {
+        close(dir.fd);
+    }
+    free(ops);
+    close(dst_dirfd);
+}
+
+
+//du | system calls --> openat(), fdopendir(), fstatat() on a thread pool (tree_walk.c)
+//prints the total like du -s: kilobytes, tab, path
+void diskUsage(char *path) {
+    walk_totals totals;
+    if (walk_tree(path, 1, NULL, &totals) != 0) {
+        char* error_msg = "Error: Cannot open path\n";
+        write(2, error_msg, strlen(error_msg));
+        return;
+    }
+
+    char line[1200];
+    int len = snprintf(line, sizeof(line), "%llu\t%s\n", (totals.bytes + 1023) / 1024, path);
+    write(1, line, len < (int)sizeof(line) ? len : (int)sizeof(line) - 1);
+}
+
+
+//find -name | same walker as du, matches are printed by the walker threads
+void findName(char *path, char *pattern) {
+    walk_totals totals;
+    if (walk_tree(path, 0, pattern, &totals) != 0) {
+        char* error_msg = "Error: Cannot open path\n";
+        write(2, error_msg, strlen(error_msg));
+    }
+}
+
+
+// ------------------------------ grep / wc ------------------------------
+//regular files are mmap()ed and scanned in place with memchr(), which glibc
+//implements with SIMD loads, so newlines and the literal's first byte are
+//found 16-32 bytes at a time. pipes, ttys and other non-regular files fall
+//back to a read() loop over a fixed buffer. wc's word count compares 16
+//bytes at a time with GCC vector extensions (SSE2/NEON, or plain scalar
+//code on targets without either).
+
+#define SCAN_BUF_SIZE (64 * 1024)
+
+//batches matching lines so grep does not write() once per line
+typedef struct {
+    char data[SCAN_BUF_SIZE];
+    size_t len;
+} out_buffer;
+
+static void out_buffer_flush(out_buffer *out) {
+    size_t done = 0;
+    while (done < out->len) {
+        ssize_t n = write(1, out->data + done, out->len - done);
+        if (n <= 0) break;
+        done += n;
+    }
+    out->len = 0;
+}
+
+static void out_buffer_add(out_buffer *out, const char *data, size_t len) {
+    if (out->len + len > sizeof(out->data)) {
+        out_buffer_flush(out);
+    }
+    //longer than the whole buffer: write it straight through
+    if (len > sizeof(out->data)) {
+        write(1, data, len);
+        return;
+    }
+    memcpy(out->data + out->len, data, len);
+    out->len += len;
+}
+
+//print every line of buf[0..len) that contains the literal
+//buf holds whole lines only (the last one may lack its '\n')
+static void grep_lines(const char *buf, size_t len, const char *literal, size_t lit_len, out_buffer *out) {
+    const char *end = buf + len;
+    const char *p = buf;
+
+    while (p < end) {
+        const char *hit;
+        if (lit_len == 0) {
+            hit = p;
+        } else {
+            //jump straight to the next candidate first byte
+            hit = memchr(p, literal[0], end - p);
+            if (hit == NULL) break;
+            if ((size_t)(end - hit) < lit_len) break;
+            if (memcmp(hit, literal, lit_len) != 0) {
+                p = hit + 1;
+                continue;
+            }
+        }
+
+        //widen the hit to its whole line
+        const char *line_start = hit;
+        while (line_start > buf && line_start[-1] != '\n') line_start--;
+        const char *line_end = memchr(hit, '\n', end - hit);
+        line_end = line_end ? line_end + 1 : end;
+
+        out_buffer_add(out, line_start, line_end - line_start);
+        if (line_end[-1] != '\n') {
+            out_buffer_add(out, "\n", 1);
+        }
+        p = line_end;
+    }
+}
+
+//lookup table: 1 for the bytes wc treats as word separators
+static const unsigned char wc_space[256] = {
+    [' '] = 1, ['\t'] = 1, ['\n'] = 1, ['\v'] = 1, ['\f'] = 1, ['\r'] = 1,
+};
+
+//16 bytes of a file, compared lane by lane
+typedef unsigned char wc_vec __attribute__((vector_size(16)));
+
+//0xff in every lane of v that holds a word separator (' ', '\t'..'\r')
+static inline wc_vec wc_space_lanes(wc_vec v) {
+    return (wc_vec)((v == ' ') | ((v >= '\t') & (v <= '\r')));
+}
+
+typedef struct {
+    unsigned long long lines;
+    unsigned long long words;
+    unsigned long long bytes;
+    //carried between chunks so a word split by a read() is counted once
+    int in_word;
+} wc_counts;
+
+static void wc_chunk(const char *buf, size_t len, wc_counts *counts) {
+    const char *end = buf + len;
+
+    //line count: memchr skips whole vectors without a newline
+    for (const char *p = buf; (p = memchr(p, '\n', end - p)) != NULL; p++) {
+        counts->lines++;
+    }
+
+    if (len == 0) {
+        return;
+    }
+
+    //words: count the starts of non-space runs, a non-separator after a
+    //separator (the byte before buf is the previous chunk's last one)
+    const unsigned char *bytes = (const unsigned char*)buf;
+    counts->words += !wc_space[bytes[0]] & !counts->in_word;
+    size_t i = 1;
+
+    //16 starts at a time: the block loaded one byte earlier gives every
+    //lane the byte before it; lanes count up to 255 blocks before they
+    //are added into words
+    while (len - i >= 16) {
+        size_t blocks = (len - i) / 16;
+        if (blocks > 255) blocks = 255;
+        wc_vec starts = { 0 };
+        for (size_t b = 0; b < blocks; b++, i += 16) {
+            wc_vec cur, prev;
+            memcpy(&cur, bytes + i, sizeof(cur));
+            memcpy(&prev, bytes + i - 1, sizeof(prev));
+            starts -= ~wc_space_lanes(cur) & wc_space_lanes(prev);
+        }
+        for (int lane = 0; lane < 16; lane++) {
+            counts->words += starts[lane];
+        }
+    }
+    for (; i < len; i++) {
+        counts->words += wc_space[bytes[i - 1]] & !wc_space[bytes[i]];
+    }
+
+    counts->in_word = !wc_space[bytes[len - 1]];
+    counts->bytes += len;
+}
+
+//open filename for grep/wc: a directory cannot be read, say so
+//returns the fd, or -1 after printing an error
+static int open_text_file(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        char* error_msg = "Error: Cannot open file\n";
+        write(2, error_msg, strlen(error_msg));
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISDIR(st.st_mode)) {
+        char* error_msg = "Error: Is a directory\n";
+        write(2, error_msg, strlen(error_msg));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+//map a regular, non-empty file; returns NULL for anything else
+static const char* map_file(int fd, size_t *len) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        return NULL;
+    }
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    *len = st.st_size;
+    return data;
+}
+
+
+//grep | system calls --> open(), mmap() or read(), write(), close()
+void searchFile(char *literal, char *filename) {
+    int fd = open_text_file(filename);
+    if (fd < 0) {
+        return;
+    }
+
+    size_t lit_len = strlen(literal);
+    out_buffer *out = malloc(sizeof(out_buffer));
+    if (out == NULL) {
+        close(fd);
+        return;
+    }
+    out->len = 0;
+
+    size_t map_len;
+    const char *data = map_file(fd, &map_len);
+    if (data != NULL) {
+        grep_lines(data, map_len, literal, lit_len, out);
+        munmap((void*)data, map_len);
+    } else {
+        //streaming: keep the unfinished last line at the front of the buffer
+        size_t capacity = SCAN_BUF_SIZE;
+        size_t held = 0;
+        char *buffer = malloc(capacity);
+        ssize_t bytes_read;
+
+        while (buffer != NULL && (bytes_read = read(fd, buffer + held, capacity - held)) > 0) {
+            held += bytes_read;
+            const char *last_nl = memrchr(buffer, '\n', held);
+            if (last_nl == NULL) {
+                //one line longer than the buffer: grow it
+                if (held == capacity) {
+                    char *grown = realloc(buffer, capacity * 2);
+                    if (grown == NULL) break;
+                    buffer = grown;
+                    capacity *= 2;
+                }
+                continue;
+            }
+            size_t complete = last_nl - buffer + 1;
+            grep_lines(buffer, complete, literal, lit_len, out);
+            memmove(buffer, buffer + complete, held - complete);
+            held -= complete;
+        }
+        if (buffer != NULL && held > 0) {
+            grep_lines(buffer, held, literal, lit_len, out);
+        }
+        free(buffer);
+    }
+
+    out_buffer_flush(out);
+    free(out);
+    close(fd);
+}
+
+
+//wc | system calls --> open(), mmap() or read(), write(), close()
+//prints lines, words and bytes like wc
+void wordCount(char *filename) {
+    int fd = open_text_file(filename);
+    if (fd < 0) {
+        return;
+    }
+
+    wc_counts counts = { 0, 0, 0, 0 };
+    size_t map_len;
+    const char *data = map_file(fd, &map_len);
+    if (data != NULL) {
+        wc_chunk(data, map_len, &counts);
+        munmap((void*)data, map_len);
+    } else {
+        char buffer[SCAN_BUF_SIZE];
+        ssize_t bytes_read;
+        while ((bytes_read = read(fd, buffer, sizeof(buffer))) > 0) {
+            wc_chunk(buffer, bytes_read, &counts);
+        }
+    }
+    close(fd);
+
+    char line[1200];
+    int len = snprintf(line, sizeof(line), "%llu %llu %llu %s\n",
+                       counts.lines, counts.words, counts.bytes, filename);
+    write(1, line, len < (int)sizeof(line) ? len : (int)sizeof(line) - 1);
+}
@@ -25,3 +25,15 @@ void moveFile(char *sourcePath, char *destinationPath); /*for the mv command*/
 void deleteFile(char *filename); /*for the rm command*/
 
 void displayFile(char *filename); /*for the cat command*/
+
+void deleteFiles(char **paths, int count); /*for rm with several operands and/or * ? patterns*/
+
+void copyFiles(char **sourcePaths, int count, char *destinationDir); /*for cp with several sources into one directory*/
+
+void diskUsage(char *path); /*for the du command*/
+
+void findName(char *path, char *pattern); /*for the find command (find [path] -name pattern)*/
+
+void searchFile(char *literal, char *filename); /*for the grep command (literal text only)*/
+
+void wordCount(char *filename); /*for the wc command*/
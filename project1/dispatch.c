@@ -0,0 +1,162 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include "command.h"
+#include "dispatch.h"
+
+// ------------------------------ Argument Counts ------------------------------
+    //tokens each handler takes, command name included, indexed by command_id
+    //cp takes one source (CMD_CP) or several/a pattern (CMD_CP_MANY);
+    //find's -name is always token num_tokens - 2, its pattern the last one
+static const struct
+{
+    int min_tokens;
+    int max_tokens;
+}arity[CMD_COUNT] = {
+    [CMD_EXIT] = { 1, INT_MAX },    //arguments are ignored
+    [CMD_LS] = { 1, 1 },
+    [CMD_PWD] = { 1, 1 },
+    [CMD_MKDIR] = { 2, 2 },
+    [CMD_CD] = { 2, 2 },
+    [CMD_CP] = { 3, 3 },
+    [CMD_CP_MANY] = { 3, INT_MAX },
+    [CMD_MV] = { 3, 3 },
+    [CMD_RM] = { 2, INT_MAX },
+    [CMD_CAT] = { 2, 2 },
+    [CMD_DU] = { 1, 2 },            //optional path
+    [CMD_FIND] = { 3, 4 },          //optional path before -name
+    [CMD_GREP] = { 3, 3 },
+    [CMD_WC] = { 2, 2 },
+    [CMD_ERROR] = { 1, 1 },         //the message
+};
+
+int command_fits(int id, int num_tokens) {
+    if (id < 0 || id >= CMD_COUNT) {
+        return 0;
+    }
+    return num_tokens >= arity[id].min_tokens && num_tokens <= arity[id].max_tokens;
+}
+
+
+// ------------------------------ Matching Commands ------------------------------
+    //match command to command.c, then check the number of arguments
+    //args[0] is the command name, so every count includes it
+int resolve_command(char **args, int num_tokens, char *err_buf, size_t err_size) {
+    char* command = args[0];
+    int id;
+
+    if (strcmp(command, "exit") == 0) {
+        id = CMD_EXIT;
+    }
+    else if (strcmp(command, "ls") == 0) {
+        id = CMD_LS;
+    }
+    else if (strcmp(command, "pwd") == 0) {
+        id = CMD_PWD;
+    }
+    else if (strcmp(command, "mkdir") == 0) {
+        id = CMD_MKDIR;
+    }
+    else if (strcmp(command, "cd") == 0) {
+        id = CMD_CD;
+    }
+    else if (strcmp(command, "cp") == 0) {
+        //several sources or a pattern: last token is the target directory
+        id = (num_tokens == 3 && strpbrk(args[1], "*?") == NULL) ? CMD_CP : CMD_CP_MANY;
+    }
+    else if (strcmp(command, "mv") == 0) {
+        id = CMD_MV;
+    }
+    else if (strcmp(command, "rm") == 0) {
+        id = CMD_RM; // 'rm' takes 1 or more files/patterns
+    }
+    else if (strcmp(command, "cat") == 0) {
+        id = CMD_CAT;
+    }
+    else if (strcmp(command, "du") == 0) {
+        id = CMD_DU;
+    }
+    else if (strcmp(command, "find") == 0) {
+        // find -name <pattern> | find <path> -name <pattern>
+        id = CMD_FIND;
+        if (command_fits(id, num_tokens) && strcmp(args[num_tokens - 2], "-name") != 0) {
+            id = CMD_ERROR;
+        }
+    }
+    else if (strcmp(command, "grep") == 0) {
+        id = CMD_GREP; // 'grep' takes a literal and a file
+    }
+    else if (strcmp(command, "wc") == 0) {
+        id = CMD_WC;
+    }
+    else {
+        snprintf(err_buf, err_size, "Error! Unrecognized command: %s\n", command);
+        return CMD_ERROR;
+    }
+
+    if (id == CMD_ERROR || !command_fits(id, num_tokens)) {
+        snprintf(err_buf, err_size, "Error! Unsupported parameters for command: %s\n", command);
+        return CMD_ERROR;
+    }
+    return id;
+}
+
+
+// ------------------------------ Handlers ------------------------------
+    //one per command_id, arguments are already checked by resolve_command
+static int run_exit(char **args, int num_tokens) { (void)args; (void)num_tokens; return 1; }
+static int run_ls(char **args, int num_tokens) { (void)args; (void)num_tokens; listDir(); return 0; }
+static int run_pwd(char **args, int num_tokens) { (void)args; (void)num_tokens; showCurrentDir(); return 0; }
+static int run_mkdir(char **args, int num_tokens) { (void)num_tokens; makeDir(args[1]); return 0; }
+static int run_cd(char **args, int num_tokens) { (void)num_tokens; changeDir(args[1]); return 0; }
+static int run_cp(char **args, int num_tokens) { (void)num_tokens; copyFile(args[1], args[2]); return 0; }
+static int run_cp_many(char **args, int num_tokens) { copyFiles(&args[1], num_tokens - 2, args[num_tokens - 1]); return 0; }
+static int run_mv(char **args, int num_tokens) { (void)num_tokens; moveFile(args[1], args[2]); return 0; }
+static int run_rm(char **args, int num_tokens) { deleteFiles(&args[1], num_tokens - 1); return 0; }
+static int run_cat(char **args, int num_tokens) { (void)num_tokens; displayFile(args[1]); return 0; }
+static int run_du(char **args, int num_tokens) { diskUsage(num_tokens == 2 ? args[1] : "."); return 0; }
+static int run_grep(char **args, int num_tokens) { (void)num_tokens; searchFile(args[1], args[2]); return 0; }
+static int run_wc(char **args, int num_tokens) { (void)num_tokens; wordCount(args[1]); return 0; }
+
+static int run_find(char **args, int num_tokens) {
+    if (num_tokens == 3) {
+        findName(".", args[2]);
+    } else {
+        findName(args[1], args[3]);
+    }
+    return 0;
+}
+
+static int run_error(char **args, int num_tokens) {
+    (void)num_tokens;
+    write(STDERR_FILENO, args[0], strlen(args[0]));
+    return 0;
+}
+
+//indexed by command_id
+static int (*const handlers[CMD_COUNT])(char **args, int num_tokens) = {
+    [CMD_EXIT] = run_exit,
+    [CMD_LS] = run_ls,
+    [CMD_PWD] = run_pwd,
+    [CMD_MKDIR] = run_mkdir,
+    [CMD_CD] = run_cd,
+    [CMD_CP] = run_cp,
+    [CMD_CP_MANY] = run_cp_many,
+    [CMD_MV] = run_mv,
+    [CMD_RM] = run_rm,
+    [CMD_CAT] = run_cat,
+    [CMD_DU] = run_du,
+    [CMD_FIND] = run_find,
+    [CMD_GREP] = run_grep,
+    [CMD_WC] = run_wc,
+    [CMD_ERROR] = run_error,
+};
+
+int execute_command(int id, char **args, int num_tokens) {
+    if (id < 0 || id >= CMD_COUNT) {
+        return 0;
+    }
+    return handlers[id](args, num_tokens);
+}
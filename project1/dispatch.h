@@ -0,0 +1,49 @@
+/*
+ *	Purpose: Turns a tokenized command into a handler index once, then runs
+ *			 it through a function table. Interactive and -f mode resolve and
+ *			 execute back to back; a compiled plan (plan.c) stores the index
+ *			 so the name lookup and argument checks are never repeated.
+ *
+ */
+
+#ifndef DISPATCH_H_
+#define DISPATCH_H_
+
+#include <stddef.h>
+
+// handler indices, stored as-is in compiled plans:
+// only append new entries and bump PLAN_VERSION in plan.h when this changes
+typedef enum
+{
+    CMD_EXIT = 0,
+    CMD_LS,
+    CMD_PWD,
+    CMD_MKDIR,
+    CMD_CD,
+    CMD_CP,         // cp <file> <file|dir>
+    CMD_CP_MANY,    // cp <src>... <dir> (several sources or a pattern)
+    CMD_MV,
+    CMD_RM,
+    CMD_CAT,
+    CMD_DU,
+    CMD_FIND,       // find -name <pattern> | find <path> -name <pattern>
+    CMD_GREP,
+    CMD_WC,
+    CMD_ERROR,      // invalid command, the only token is the error message
+    CMD_COUNT
+}command_id;
+
+//match args[0] and check the number of arguments
+//returns a command_id; for CMD_ERROR the message is left in err_buf
+int resolve_command(char **args, int num_tokens, char *err_buf, size_t err_size);
+
+//does num_tokens (command name included) fit handler id, no string compares
+//(a compiled plan is checked with this instead of resolve_command)
+int command_fits(int id, int num_tokens);
+
+//run a resolved command, args[0] is the command name (or the error message)
+//returns 1 when the shell should exit
+int execute_command(int id, char **args, int num_tokens);
+
+
+#endif /* DISPATCH_H_ */
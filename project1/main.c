@@ -0,0 +1,191 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "command.h"
+#include "string_parser.h"
+#include "dispatch.h"
+#include "plan.h"
+
+// ------------------------------ Matching Commands ------------------------------
+    //match command to its handler (dispatch.c) and run it
+    //space_commands.command_list takes in command name as first token
+int process_command(command_line* space_commands) {
+    char err_buf[1024];
+    int id = resolve_command(space_commands->command_list, space_commands->num_token,
+                             err_buf, sizeof(err_buf));
+    if (id == CMD_ERROR) {
+        write(STDERR_FILENO, err_buf, strlen(err_buf));
+        return 0;
+    }
+    return execute_command(id, space_commands->command_list, space_commands->num_token);
+}
+
+
+//file mode output: STDOUT and STDERR both go to output.txt
+//returns 0 on success
+int redirect_output() {
+    //open output file for writing with open() system call
+    //gives file descriptor
+    int foutput = open("output.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (foutput == -1) {
+        perror("Error opening output.txt");
+        return 1;
+    }
+
+    //redirect STDOUT (file descriptor 1) to point to output.txt
+    dup2(foutput, STDOUT_FILENO);
+    //add in redirection for STDERR
+    dup2(foutput, STDERR_FILENO);
+    close(foutput);
+    return 0;
+}
+
+
+// ------------------------------ Core Program ------------------------------
+// needs to be able to read, parse, and execute by reading from command.c
+int main(int argc, char *argv[]) {
+
+    //default for interactive mode input
+    FILE *input_stream = stdin;
+    //default for file mode
+    int interactive_mode = 0;
+    // ---------------------------------- INTERACTIVE MODE ----------------------------------
+    if (argc == 1) {
+        //set flag to interactive mode on
+        interactive_mode = 1;
+        //run in interactive mode
+        //argv[0] --> psuedo-shell
+
+    // ---------------------------------- FILE MODE ----------------------------------
+    } else if (argc == 3 && strcmp(argv[1], "-f") == 0) {
+        //run in file mode
+        //argv[0] --> psuedo-shell
+        //argv[1] --> "-f"
+        //argv[2] --> input filename
+        
+        // ------------------------------ Open Input ------------------------------
+        //open input file for reading
+        input_stream = fopen(argv[2], "r");
+        if (input_stream == NULL) {
+            perror("Error opening input file");
+            return 1;
+        }
+
+        // ------------------------------ Open Output ------------------------------
+        if (redirect_output() != 0) {
+            fclose(input_stream);
+            return 1;
+        }
+
+    // ---------------------------------- COMPILE PLAN ----------------------------------
+    } else if (argc == 4 && strcmp(argv[1], "--compile") == 0) {
+        //argv[2] --> script (same format as -f)
+        //argv[3] --> plan file to write
+        return compile_plan(argv[2], argv[3]);
+
+    // ---------------------------------- RUN PLAN ----------------------------------
+    } else if (argc == 3 && strcmp(argv[1], "--run-plan") == 0) {
+        //behaves like file mode, without parsing anything
+        if (redirect_output() != 0) {
+            return 1;
+        }
+        //a corrupt plan ran nothing: no farewell, and a failing status
+        if (run_plan(argv[2]) != 0) {
+            return 1;
+        }
+        write(STDOUT_FILENO, "End of file\n", 12);
+        write(STDOUT_FILENO, "Bye Bye!\n", 9);
+        return 0;
+
+        // ------------------------------ Error Handling ------------------------------
+    } else {
+        //error, invalid # of arguments
+        //exit
+        char err_buf[1024];
+        snprintf(err_buf, sizeof(err_buf), "Usage: %s [-f <filename> | --compile <filename> <plan> | --run-plan <plan>]\n", argv[0]);
+        write(STDERR_FILENO, err_buf, strlen(err_buf));
+        return 1;
+    }
+
+    // ------------------------------ Unified Processing Loop ------------------------------
+    char* line_buf = NULL;
+    size_t line_buf_size = 0;
+    //hold return value
+     ssize_t line_size; 
+    //flag to handle exit command
+    int should_exit = 0;
+
+    while(1) {
+        if (interactive_mode) {
+            write(STDOUT_FILENO, ">>>", 4);
+        }
+            
+        //read input from stdin (keyboard)
+        line_size = getline(&line_buf, &line_buf_size, input_stream);
+
+        //check for error
+        if (line_size < 0) {
+            break;
+        }
+
+        // ------------------------------ Parsing Commands ------------------------------
+        //parse into individual command strings (delimiter is semicolon)
+        command_line semi_colon_commands  = str_filler(line_buf, ";");
+            
+        for (int i = 0; i < semi_colon_commands.num_token; i++) {
+            //get single command string
+            char* single_command_str = semi_colon_commands.command_list[i];
+        
+            //parse commands into commands and argument
+            command_line space_commands = str_filler(single_command_str, " ");
+                
+            if (space_commands.num_token == 0) {
+                //free result of space parsing
+                free_command_line(&space_commands);
+                continue;
+            }
+
+            if (process_command(&space_commands)) {
+                //set flag for main while(1) loop
+                should_exit = 1;
+                //free space_commands before breaking --> prevent memory leak
+                free_command_line(&space_commands);
+
+                break;
+            }
+            
+        // -------------------------- While Loop Cleanup --------------------------
+        //free space commands
+            free_command_line(&space_commands);
+        } //end loop for semicolons
+            
+        //free result of semicolon parsing
+        free_command_line(&semi_colon_commands);
+
+        //check if flag indicates to exit main while loop
+        if (should_exit) {
+            break;
+        }
+    }
+
+     // ------------------------------ Final Cleanup ------------------------------
+    //free the buffer
+    free(line_buf);
+    //reset pointer for extra safety
+    line_buf = NULL;
+        
+    if (input_stream != stdin) {
+        fclose(input_stream);
+    }
+
+    if(!interactive_mode) {
+        write(STDOUT_FILENO, "End of file\n", 12);
+    }
+
+    write(STDOUT_FILENO, "Bye Bye!\n", 9);
+
+    return 0;
+}
\ No newline at end of file
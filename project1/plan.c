@@ -0,0 +1,274 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "string_parser.h"
+#include "dispatch.h"
+#include "plan.h"
+
+// fixed-size part at the start of every plan
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t num_records;
+}plan_header;
+
+// one checked record of a plan being run, its args start at tokens[first]
+typedef struct
+{
+    uint32_t id;
+    uint32_t num_tokens;
+    size_t first;
+}plan_record;
+
+// growable byte buffer the records are serialized into
+typedef struct
+{
+    char *data;
+    size_t len;
+    size_t cap;
+}plan_buffer;
+
+static int buffer_add(plan_buffer *buf, const void *data, size_t len) {
+    if (buf->len + len > buf->cap) {
+        size_t capacity = buf->cap ? buf->cap * 2 : 4096;
+        while (capacity < buf->len + len) capacity *= 2;
+        char *grown = realloc(buf->data, capacity);
+        if (grown == NULL) return -1;
+        buf->data = grown;
+        buf->cap = capacity;
+    }
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    return 0;
+}
+
+static int add_record(plan_buffer *buf, uint32_t id, char **tokens, uint32_t num_tokens) {
+    if (buffer_add(buf, &id, sizeof(id)) != 0) return -1;
+    if (buffer_add(buf, &num_tokens, sizeof(num_tokens)) != 0) return -1;
+    for (uint32_t i = 0; i < num_tokens; i++) {
+        if (buffer_add(buf, tokens[i], strlen(tokens[i]) + 1) != 0) return -1;
+    }
+    return 0;
+}
+
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n <= 0) return -1;
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+
+// ------------------------------ Compile ------------------------------
+//same parsing as the -f loop in main.c, done once
+int compile_plan(const char *script_path, const char *plan_path) {
+    FILE *script = fopen(script_path, "r");
+    if (script == NULL) {
+        perror("Error opening input file");
+        return 1;
+    }
+
+    plan_buffer buf = { NULL, 0, 0 };
+    uint32_t num_records = 0;
+    int failed = 0;
+    int should_exit = 0;
+
+    char* line_buf = NULL;
+    size_t line_buf_size = 0;
+    char err_buf[1024];
+
+    while (!should_exit && !failed && getline(&line_buf, &line_buf_size, script) >= 0) {
+        command_line semi_colon_commands = str_filler(line_buf, ";");
+
+        for (int i = 0; i < semi_colon_commands.num_token; i++) {
+            command_line space_commands = str_filler(semi_colon_commands.command_list[i], " ");
+            if (space_commands.num_token == 0) {
+                free_command_line(&space_commands);
+                continue;
+            }
+
+            int id = resolve_command(space_commands.command_list, space_commands.num_token,
+                                     err_buf, sizeof(err_buf));
+            if (id == CMD_ERROR) {
+                //keep the exact message so the run prints what -f mode would
+                char *message = err_buf;
+                failed = add_record(&buf, id, &message, 1) != 0;
+            } else {
+                failed = add_record(&buf, id, space_commands.command_list, space_commands.num_token) != 0;
+            }
+            num_records++;
+            free_command_line(&space_commands);
+
+            //nothing after exit can run
+            if (failed || id == CMD_EXIT) {
+                should_exit = 1;
+                break;
+            }
+        }
+        free_command_line(&semi_colon_commands);
+    }
+    free(line_buf);
+    fclose(script);
+
+    if (failed) {
+        char* error_msg = "Error: Out of memory while compiling plan\n";
+        write(STDERR_FILENO, error_msg, strlen(error_msg));
+        free(buf.data);
+        return 1;
+    }
+
+    int fd = open(plan_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        perror("Error opening plan file");
+        free(buf.data);
+        return 1;
+    }
+
+    plan_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PLAN_MAGIC, sizeof(PLAN_MAGIC));
+    header.version = PLAN_VERSION;
+    header.num_records = num_records;
+
+    int status = 0;
+    if (write_all(fd, (const char*)&header, sizeof(header)) != 0 ||
+        write_all(fd, buf.data, buf.len) != 0) {
+        perror("Error writing plan file");
+        status = 1;
+    }
+    close(fd);
+    free(buf.data);
+    return status;
+}
+
+
+// ------------------------------ Run ------------------------------
+int run_plan(const char *plan_path) {
+    int fd = open(plan_path, O_RDONLY);
+    if (fd < 0) {
+        perror("Error opening plan file");
+        return -1;
+    }
+
+    //slurp the whole plan: argument strings are used in place
+    struct stat st;
+    char *data = NULL;
+    size_t size = 0;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(plan_header)) {
+        size = st.st_size;
+        data = malloc(size);
+        size_t done = 0;
+        while (data != NULL && done < size) {
+            ssize_t n = read(fd, data + done, size - done);
+            if (n <= 0) break;
+            done += n;
+        }
+        if (done != size) {
+            free(data);
+            data = NULL;
+        }
+    }
+    close(fd);
+
+    plan_header header;
+    if (data != NULL) {
+        memcpy(&header, data, sizeof(header));
+    }
+    if (data == NULL || memcmp(header.magic, PLAN_MAGIC, sizeof(PLAN_MAGIC)) != 0 ||
+        header.version != PLAN_VERSION) {
+        char* error_msg = "Error: Not a compiled plan (or compiled by another version)\n";
+        write(STDERR_FILENO, error_msg, strlen(error_msg));
+        free(data);
+        return -1;
+    }
+
+    //one walk over the plan checks every record against its handler's
+    //argument count and points its args at the strings in place; records
+    //only run once all of them checked out, so a corrupt plan runs nothing
+    //(every record takes at least 8 header bytes and one string byte)
+    char *end = data + size;
+    uint32_t num_records = header.num_records;
+    plan_record *records = NULL;
+    if (num_records <= (size - sizeof(plan_header)) / 9) {
+        records = malloc((num_records + 1) * sizeof(plan_record));
+    }
+    //every record's args, each followed by a NULL
+    char **tokens = NULL;
+    size_t num_tokens_total = 0;
+    size_t tokens_cap = 0;
+    int status = records == NULL ? -1 : 0;
+
+    char *p = data + sizeof(plan_header);
+    for (uint32_t r = 0; r < num_records && status == 0; r++) {
+        uint32_t id, num_tokens;
+        if ((size_t)(end - p) < sizeof(id) + sizeof(num_tokens)) {
+            status = -1;
+            break;
+        }
+        memcpy(&id, p, sizeof(id));
+        memcpy(&num_tokens, p + sizeof(id), sizeof(num_tokens));
+        p += sizeof(id) + sizeof(num_tokens);
+
+        //a record whose arguments do not fit its handler would make it
+        //read past args
+        if (num_tokens > (size_t)(end - p) || !command_fits(id, num_tokens)) {
+            status = -1;
+            break;
+        }
+        if (num_tokens_total + num_tokens + 1 > tokens_cap) {
+            size_t capacity = tokens_cap ? tokens_cap * 2 : 256;
+            while (capacity < num_tokens_total + num_tokens + 1) capacity *= 2;
+            char **grown = realloc(tokens, capacity * sizeof(char*));
+            if (grown == NULL) {
+                status = -1;
+                break;
+            }
+            tokens = grown;
+            tokens_cap = capacity;
+        }
+
+        //point at the strings, checking each one ends inside the plan
+        char **args = tokens + num_tokens_total;
+        uint32_t i;
+        for (i = 0; i < num_tokens; i++) {
+            char *nul = memchr(p, '\0', end - p);
+            if (nul == NULL) break;
+            args[i] = p;
+            p = nul + 1;
+        }
+        if (i != num_tokens) {
+            status = -1;
+            break;
+        }
+        args[num_tokens] = NULL;
+
+        records[r].id = id;
+        records[r].num_tokens = num_tokens;
+        records[r].first = num_tokens_total;
+        num_tokens_total += num_tokens + 1;
+    }
+
+    for (uint32_t r = 0; r < num_records && status == 0; r++) {
+        if (execute_command(records[r].id, tokens + records[r].first, records[r].num_tokens)) {
+            break;
+        }
+    }
+
+    if (status != 0) {
+        char* error_msg = "Error: Plan file is truncated or corrupt\n";
+        write(STDERR_FILENO, error_msg, strlen(error_msg));
+    }
+    free(tokens);
+    free(records);
+    free(data);
+    return status;
+}
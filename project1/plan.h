@@ -0,0 +1,31 @@
+/*
+ *	Purpose: Precompiled batch scripts. --compile reads a -f script once,
+ *			 splits it into commands and arguments, resolves every command to
+ *			 its handler index and checks its arguments, and saves the result
+ *			 as a binary plan. --run-plan executes that plan without any
+ *			 getline/tokenizing/strcmp work.
+ *
+ *	Layout (native byte order, plans are not portable between machines):
+ *		header:  char magic[8] = "PSHPLAN", uint32 version, uint32 record count
+ *		record:  uint32 handler (command_id), uint32 num_tokens,
+ *		         then num_tokens NUL-terminated strings
+ *
+ */
+
+#ifndef PLAN_H_
+#define PLAN_H_
+
+#define PLAN_MAGIC "PSHPLAN"
+//bump whenever command_id in dispatch.h changes
+#define PLAN_VERSION 1
+
+//compile script_path into plan_path, returns 0 on success
+int compile_plan(const char *script_path, const char *plan_path);
+
+//execute every record of plan_path, stopping at exit
+//returns 0 on success, -1 if the plan cannot be read or is malformed
+//(every record's argument count is checked before any of them runs)
+int run_plan(const char *plan_path);
+
+
+#endif /* PLAN_H_ */
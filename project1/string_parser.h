@@ -0,0 +1,36 @@
+/*
+ *	Purpose: The goal of this dynamic helper string struct is to reliably 
+ *			 tokenize strings base on different delimeter. Following this structure
+ *           would help to keep the code clean.
+ *
+ */
+
+#ifndef STRING_PARSER_H_
+#define STRING_PARSER_H_
+
+
+#define _GNU_SOURCE
+
+// main datatype container
+typedef struct
+{
+    //dynamic array of strings
+    char** command_list;
+    //count of how many tokens
+    int num_token;
+}command_line;
+
+//this functions returns the number of tokens needed for the string array
+//based on the delimeter
+int count_token (char* buf, const char* delim);
+
+//This functions can tokenize a string to token arrays base on a specified delimeter,
+//it returns a struct variable
+command_line str_filler (char* buf, const char* delim);
+
+
+//this function safely free all the tokens within the array.
+void free_command_line(command_line* command);
+
+
+#endif /* STRING_PARSER_H_ */
@@ -345,6 +345,31 @@ EOF
     cd ..
 }
 
+test_rm_multiple_command() {
+    echo "Testing 'rm' command with several files and a pattern..."
+    cd $TEST_DIR
+
+    touch rm_a.txt rm_b.txt rm_c.log rm_d.log
+
+    valgrind_output=$(valgrind ../$EXECUTABLE 2>&1 <<-EOF
+rm rm_a.txt rm_b.txt rm_*.log
+exit
+EOF
+    )
+
+    process_valgrind_output "$valgrind_output"
+
+    if [ ! -e rm_a.txt ] && [ ! -e rm_b.txt ] && [ ! -e rm_c.log ] && [ ! -e rm_d.log ]; then
+        echo "'rm' command successfully removed all files."
+    else
+        echo "Error: 'rm' command failed to remove every file."
+    fi
+
+    echo ""
+
+    cd ..
+}
+
 
 #---------------------------
 # CP tests
@@ -450,6 +475,78 @@ test_cp_file_to_subdir() {
     test_cp_base "file to subdir" "source_file.txt" "subdir/" "subdir/source_file.txt"
 }
 
+test_cp_multiple() {
+    echo "=== Testing 'cp' command: several files to directory ==="
+    cd $TEST_DIR
+
+    mkdir -p cp_many_dir cp_many_src
+    echo "First source." > cp_a.txt
+    echo "Second source." > cp_b.txt
+    echo "Third source." > cp_many_src/cp_c.txt
+    # copies keep the source's permission bits
+    chmod 750 cp_b.txt
+
+    # sources from two parent directories, interleaved
+    valgrind_output=$(valgrind ../$EXECUTABLE 2>&1 <<-EOF
+cp cp_a.txt cp_many_src/cp_c.txt cp_b.txt cp_many_dir/
+exit
+EOF
+    )
+    rm -f cp_many_dir/*
+    ../$EXECUTABLE > /dev/null 2>&1 <<-EOF
+cp cp_a.txt cp_many_src/cp_c.txt cp_b.txt cp_many_dir/
+exit
+EOF
+
+    process_valgrind_output "$valgrind_output"
+    verify_copy "cp_a.txt" "cp_many_dir/cp_a.txt" "several files, first"
+    verify_copy "cp_many_src/cp_c.txt" "cp_many_dir/cp_c.txt" "several files, other directory"
+    verify_copy "cp_b.txt" "cp_many_dir/cp_b.txt" "several files, third"
+    mode=$(stat -c %a cp_many_dir/cp_b.txt 2>/dev/null)
+    if [ "$mode" == "750" ]; then
+        echo "Success: 'cp' kept the source's mode."
+    else
+        echo "ERROR: 'cp' gave the copy mode '$mode' instead of the source's 750."
+    fi
+
+    echo ""
+    cd ..
+}
+
+test_cp_missing_source() {
+    echo "=== Testing 'cp' command: several files, one missing ==="
+    cd $TEST_DIR
+
+    mkdir -p cp_partial_dir
+    echo "First source." > cp_a.txt
+
+    valgrind_output=$(valgrind ../$EXECUTABLE 2>&1 <<-EOF
+cp cp_a.txt cp_missing.txt cp_partial_dir/
+exit
+EOF
+    )
+    pseudo_shell_output=$(../$EXECUTABLE 2>&1 <<-EOF
+cp cp_a.txt cp_missing.txt cp_partial_dir/
+exit
+EOF
+    )
+
+    process_valgrind_output "$valgrind_output"
+    if echo "$pseudo_shell_output" | grep -q "Error"; then
+        echo "Success: 'Error' detected for the missing source."
+    else
+        echo "ERROR: 'Error' not detected for the missing source."
+    fi
+    # the other source is still copied
+    verify_copy "cp_a.txt" "cp_partial_dir/cp_a.txt" "several files, one missing"
+    if [ -e cp_partial_dir/cp_missing.txt ]; then
+        echo "ERROR: 'cp' created a file for the missing source."
+    fi
+
+    echo ""
+    cd ..
+}
+
 #---------------------------
 # MV
 test_mv_base() {
@@ -595,6 +692,195 @@ EOF
 }
 
 
+#---------------------------
+# DU / FIND
+
+# run $1 (one command) in file mode: output.txt without the trailer lines
+# on stdout, valgrind notes on stderr
+run_file_mode() {
+    echo "$1" > walk_input.txt
+    valgrind_output=$(valgrind ../$EXECUTABLE -f walk_input.txt 2>&1)
+    process_valgrind_output "$valgrind_output" >&2
+    ../$EXECUTABLE -f walk_input.txt
+    grep -v -e "^End of file$" -e "^Bye Bye!$" output.txt
+}
+
+test_du_command() {
+    echo "=== Testing 'du' command with a hard link ==="
+    cd $TEST_DIR
+
+    mkdir -p du_dir/sub
+    head -c 200000 /dev/zero > du_dir/big.bin
+    ln du_dir/big.bin du_dir/sub/big_link.bin
+    echo "small file" > du_dir/sub/small.txt
+
+    pseudo_shell_output=$(run_file_mode "du du_dir")
+    # coreutils du counts a hard linked file once too
+    expected_output=$(du -s du_dir)
+
+    if [ "$pseudo_shell_output" == "$expected_output" ]; then
+        echo "'du' command output matches expected output."
+    else
+        echo "ERROR: 'du' command output does not match expected output."
+        diff -u <(echo "$pseudo_shell_output") <(echo "$expected_output")
+    fi
+
+    echo ""
+    cd ..
+}
+
+test_find_command() {
+    echo "=== Testing 'find -name' command with a pattern ==="
+    cd $TEST_DIR
+
+    mkdir -p find_dir/a/deep find_dir/b
+    touch find_dir/top.txt find_dir/a/one.txt find_dir/a/deep/two.txt find_dir/b/three.txt
+    touch find_dir/skip.log find_dir/a/deep/skip.txt.bak
+
+    # the walker threads print in any order
+    pseudo_shell_output=$(run_file_mode "find find_dir -name *.txt" | sort)
+    expected_output=$(find find_dir -name "*.txt" | sort)
+
+    if [ "$pseudo_shell_output" == "$expected_output" ]; then
+        echo "'find' command output matches expected output."
+    else
+        echo "ERROR: 'find' command output does not match expected output."
+        diff -u <(echo "$pseudo_shell_output") <(echo "$expected_output")
+    fi
+
+    echo ""
+    cd ..
+}
+
+
+#---------------------------
+# GREP / WC
+
+# $1: command, $2: expected output (file mode, no trailer lines)
+check_file_mode() {
+    pseudo_shell_output=$(run_file_mode "$1")
+    if [ "$pseudo_shell_output" == "$2" ]; then
+        echo "'$1' output matches expected output."
+    else
+        echo "ERROR: '$1' output does not match expected output."
+        diff -u <(echo "$pseudo_shell_output") <(echo "$2")
+    fi
+}
+
+test_grep_command() {
+    echo "=== Testing 'grep' command ==="
+    cd $TEST_DIR
+
+    # the last line has no trailing newline
+    printf 'alpha\nbeta needle\ngamma\ndelta needle' > grep_file.txt
+
+    check_file_mode "grep needle grep_file.txt" "beta needle
+delta needle"
+    check_file_mode "grep missing grep_file.txt" ""
+    mkdir -p grep_dir
+    check_file_mode "grep needle grep_dir" "Error: Is a directory"
+
+    echo ""
+    cd ..
+}
+
+test_wc_command() {
+    echo "=== Testing 'wc' command ==="
+    cd $TEST_DIR
+
+    : > wc_empty.txt
+    printf 'one two\nthree' > wc_no_newline.txt
+
+    check_file_mode "wc wc_empty.txt" "0 0 0 wc_empty.txt"
+    check_file_mode "wc wc_no_newline.txt" "1 3 13 wc_no_newline.txt"
+    # long enough for the 16 byte blocks, with runs of mixed whitespace
+    seq 1 5000 | sed 's/$/ word  two\tthree\r/' > wc_long.txt
+    check_file_mode "wc wc_long.txt" "$(wc < wc_long.txt | awk '{print $1, $2, $3}') wc_long.txt"
+    mkdir -p wc_dir
+    check_file_mode "wc wc_dir" "Error: Is a directory"
+
+    echo ""
+    cd ..
+}
+
+
+#---------------------------
+# COMPILED PLANS
+
+test_plan_round_trip() {
+    echo "=== Testing --compile / --run-plan round trip ==="
+    cd $TEST_DIR
+
+    printf 'one\ntwo b\nthree b\n' > plan_src.txt
+    echo "cat plan_src.txt
+wc plan_src.txt; grep b plan_src.txt
+lsl
+ls extra
+exit
+cat plan_src.txt" > plan_script.txt
+
+    ../$EXECUTABLE -f plan_script.txt
+    mv output.txt plan_expected.txt
+
+    valgrind_output=$(valgrind ../$EXECUTABLE --compile plan_script.txt script.plan 2>&1)
+    process_valgrind_output "$valgrind_output"
+    valgrind_output=$(valgrind ../$EXECUTABLE --run-plan script.plan 2>&1)
+    process_valgrind_output "$valgrind_output"
+
+    ../$EXECUTABLE --compile plan_script.txt script.plan
+    ../$EXECUTABLE --run-plan script.plan
+
+    if cmp -s output.txt plan_expected.txt; then
+        echo "Success: the plan prints what file mode prints."
+    else
+        echo "ERROR: the plan output does not match file mode."
+        diff -u output.txt plan_expected.txt
+    fi
+
+    echo ""
+    cd ..
+}
+
+test_plan_corrupt() {
+    echo "=== Testing --run-plan with a corrupt plan ==="
+    cd $TEST_DIR
+
+    # header, then "mkdir plan_bad_dir" and a cp record with no arguments
+    # (ids from dispatch.h: CMD_MKDIR = 3, CMD_CP = 5)
+    printf 'PSHPLAN\0\1\0\0\0\2\0\0\0' > bad.plan
+    printf '\3\0\0\0\2\0\0\0mkdir\0plan_bad_dir\0' >> bad.plan
+    printf '\5\0\0\0\1\0\0\0cp\0' >> bad.plan
+
+    valgrind_output=$(valgrind ../$EXECUTABLE --run-plan bad.plan 2>&1)
+    process_valgrind_output "$valgrind_output"
+    rm -drf plan_bad_dir
+    ../$EXECUTABLE --run-plan bad.plan
+    status=$?
+
+    if grep -q "Error" output.txt && [ ! -d plan_bad_dir ] && [ $status -ne 0 ] &&
+       ! grep -q "Bye Bye!" output.txt; then
+        echo "Success: the corrupt plan was rejected before running."
+    else
+        echo "ERROR: the corrupt plan was not rejected."
+        cat output.txt
+    fi
+
+    # a truncated plan is rejected the same way
+    ../$EXECUTABLE --compile plan_script.txt script.plan
+    head -c 40 script.plan > cut.plan
+    ../$EXECUTABLE --run-plan cut.plan
+    status=$?
+    if grep -q "Error" output.txt && [ $status -ne 0 ]; then
+        echo "Success: the truncated plan was rejected."
+    else
+        echo "ERROR: the truncated plan was not rejected."
+    fi
+
+    echo ""
+    cd ..
+}
+
+
 test_error_handling() {
     cd $TEST_DIR
 
@@ -719,6 +1005,7 @@ test_pwd_command
 test_mkdir_command
 test_cd_command
 test_rm_command
+test_rm_multiple_command
 
 echo "----------------------------------"
 test_cp_file_to_file
@@ -727,6 +1014,8 @@ test_cp_file_to_dir_file
 test_cp_dir_file_to_current
 test_cp_dir_file_to_dir_file
 test_cp_file_to_subdir
+test_cp_multiple
+test_cp_missing_source
 echo "----------------------------------"
 
 cleanup_test_environment
@@ -747,6 +1036,13 @@ echo ""
 
 test_multiple_commands
 
+test_du_command
+test_find_command
+test_grep_command
+test_wc_command
+test_plan_round_trip
+test_plan_corrupt
+
 test_error_handling
 
 cleanup_test_environment
@@ -0,0 +1,465 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include "tree_walk.h"
+
+//most threads we will ever start
+#define MAX_WORKERS 64
+//flush a thread's output buffer once it holds this much
+#define OUT_FLUSH_SIZE (64 * 1024)
+
+// one directory waiting to be read: an open fd plus its path (find only)
+typedef struct
+{
+    int fd;
+    char *path;
+}walk_item;
+
+// per-thread deque: the owner pushes/pops at the tail (depth first, keeps
+// the cache warm), thieves take from the head (oldest, biggest subtrees)
+typedef struct
+{
+    pthread_mutex_t lock;
+    walk_item *items;
+    int head;
+    int tail;
+    int capacity;
+}walk_deque;
+
+// a file with several hard links, counted once at the end like du does
+typedef struct
+{
+    dev_t dev;
+    ino_t ino;
+    unsigned long long bytes;
+}walk_link;
+
+struct walk_pool;
+
+// everything one thread touches on the hot path, aligned so two workers
+// never share a cache line
+typedef struct
+{
+    _Alignas(64) walk_deque deque;
+    //private totals, merged after join (no atomics needed)
+    walk_totals totals;
+    //private output buffer for find
+    char *out;
+    size_t out_len;
+    size_t out_cap;
+    //private list of hard-linked files seen by this thread
+    walk_link *links;
+    size_t num_links;
+    size_t links_cap;
+    unsigned int seed;
+    pthread_t thread;
+    struct walk_pool *pool;
+}walk_worker;
+
+typedef struct walk_pool
+{
+    walk_worker *workers;
+    int num_workers;
+    //directories queued or being read, the walk is over when it hits 0
+    atomic_long pending;
+    //fds held open by queued items, capped by fd_budget
+    atomic_int queued_fds;
+    //workers with nothing to take sleep on idle_cond until a push (or the
+    //end of the walk); pushes only take idle_lock while one is asleep
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle_cond;
+    atomic_int idle;
+    int fd_budget;
+    int need_stat;
+    const char *pattern;
+}walk_pool;
+
+
+// ------------------------------ Deque ------------------------------
+static int deque_push(walk_deque *dq, walk_item item) {
+    pthread_mutex_lock(&dq->lock);
+    if (dq->tail == dq->capacity) {
+        if (dq->head > 0) {
+            //slide live items down instead of growing
+            memmove(dq->items, dq->items + dq->head, (dq->tail - dq->head) * sizeof(walk_item));
+            dq->tail -= dq->head;
+            dq->head = 0;
+        } else {
+            int capacity = dq->capacity ? dq->capacity * 2 : 64;
+            walk_item *grown = realloc(dq->items, capacity * sizeof(walk_item));
+            if (grown == NULL) {
+                pthread_mutex_unlock(&dq->lock);
+                return -1;
+            }
+            dq->items = grown;
+            dq->capacity = capacity;
+        }
+    }
+    dq->items[dq->tail++] = item;
+    pthread_mutex_unlock(&dq->lock);
+    return 0;
+}
+
+//from_head: 1 when stealing, 0 when the owner pops
+static int deque_take(walk_deque *dq, walk_item *item, int from_head) {
+    pthread_mutex_lock(&dq->lock);
+    if (dq->head == dq->tail) {
+        pthread_mutex_unlock(&dq->lock);
+        return 0;
+    }
+    if (from_head) {
+        *item = dq->items[dq->head++];
+    } else {
+        *item = dq->items[--dq->tail];
+    }
+    if (dq->head == dq->tail) {
+        dq->head = dq->tail = 0;
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return 1;
+}
+
+//try every other worker once, starting at a random victim
+static int steal(walk_worker *self, walk_item *item) {
+    walk_pool *pool = self->pool;
+    int start = rand_r(&self->seed) % pool->num_workers;
+    for (int i = 0; i < pool->num_workers; i++) {
+        walk_worker *victim = &pool->workers[(start + i) % pool->num_workers];
+        if (victim != self && deque_take(&victim->deque, item, 1)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+//a directory was queued: wake one sleeping worker to take it
+static void wake_idle(walk_pool *pool) {
+    if (atomic_load(&pool->idle) == 0) {
+        return;
+    }
+    pthread_mutex_lock(&pool->idle_lock);
+    pthread_cond_signal(&pool->idle_cond);
+    pthread_mutex_unlock(&pool->idle_lock);
+}
+
+//nothing to take or steal: sleep until something is queued or the walk is
+//over (idle goes up before queued_fds is checked, and a push bumps
+//queued_fds before it checks idle, so one of the two always sees the other)
+static void wait_for_work(walk_pool *pool) {
+    pthread_mutex_lock(&pool->idle_lock);
+    atomic_fetch_add(&pool->idle, 1);
+    while (atomic_load(&pool->queued_fds) == 0 && atomic_load(&pool->pending) != 0) {
+        pthread_cond_wait(&pool->idle_cond, &pool->idle_lock);
+    }
+    atomic_fetch_sub(&pool->idle, 1);
+    pthread_mutex_unlock(&pool->idle_lock);
+}
+
+
+// ------------------------------ Output ------------------------------
+static void out_flush(walk_worker *w) {
+    size_t done = 0;
+    while (done < w->out_len) {
+        ssize_t n = write(STDOUT_FILENO, w->out + done, w->out_len - done);
+        if (n <= 0) break;
+        done += n;
+    }
+    w->out_len = 0;
+}
+
+//append "dir/name\n" to the thread's buffer
+static void out_path(walk_worker *w, const char *dir, const char *name) {
+    size_t dir_len = dir ? strlen(dir) : 0;
+    size_t name_len = name ? strlen(name) : 0;
+    size_t need = dir_len + 1 + name_len + 1;
+
+    if (w->out_len + need > w->out_cap) {
+        size_t capacity = w->out_cap ? w->out_cap : OUT_FLUSH_SIZE;
+        while (capacity < w->out_len + need) capacity *= 2;
+        char *grown = realloc(w->out, capacity);
+        if (grown == NULL) return;
+        w->out = grown;
+        w->out_cap = capacity;
+    }
+
+    char *p = w->out + w->out_len;
+    memcpy(p, dir, dir_len);
+    p += dir_len;
+    if (name != NULL) {
+        //avoid "//" when dir is the root directory
+        if (dir_len == 0 || dir[dir_len - 1] != '/') *p++ = '/';
+        memcpy(p, name, name_len);
+        p += name_len;
+    }
+    *p++ = '\n';
+    w->out_len = p - w->out;
+
+    if (w->out_len >= OUT_FLUSH_SIZE) {
+        out_flush(w);
+    }
+}
+
+
+// ------------------------------ Walking ------------------------------
+static char* join_path(const char *dir, const char *name) {
+    size_t dir_len = strlen(dir);
+    size_t name_len = strlen(name);
+    char *path = malloc(dir_len + name_len + 2);
+    if (path == NULL) return NULL;
+    memcpy(path, dir, dir_len);
+    if (dir_len == 0 || dir[dir_len - 1] != '/') path[dir_len++] = '/';
+    memcpy(path + dir_len, name, name_len + 1);
+    return path;
+}
+
+//remember a hard-linked file instead of counting it straight away
+static void link_add(walk_worker *w, const struct stat *st) {
+    if (w->num_links == w->links_cap) {
+        size_t capacity = w->links_cap ? w->links_cap * 2 : 256;
+        walk_link *grown = realloc(w->links, capacity * sizeof(walk_link));
+        if (grown == NULL) {
+            w->totals.bytes += (unsigned long long)st->st_blocks * 512;
+            return;
+        }
+        w->links = grown;
+        w->links_cap = capacity;
+    }
+    walk_link *link = &w->links[w->num_links++];
+    link->dev = st->st_dev;
+    link->ino = st->st_ino;
+    link->bytes = (unsigned long long)st->st_blocks * 512;
+}
+
+static int link_compare(const void *a, const void *b) {
+    const walk_link *x = a;
+    const walk_link *y = b;
+    if (x->dev != y->dev) return x->dev < y->dev ? -1 : 1;
+    if (x->ino != y->ino) return x->ino < y->ino ? -1 : 1;
+    return 0;
+}
+
+//read one directory; fd and path are owned (closed/freed) here
+static void walk_dir(walk_worker *w, int fd, char *path) {
+    walk_pool *pool = w->pool;
+
+    DIR *dir = fdopendir(fd);
+    if (dir == NULL) {
+        close(fd);
+        free(path);
+        return;
+    }
+    int dir_fd = dirfd(dir);
+    w->totals.dirs++;
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        const char *name = entry->d_name;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+            continue;
+        }
+
+        int is_dir = entry->d_type == DT_DIR;
+        if (pool->need_stat || entry->d_type == DT_UNKNOWN) {
+            struct stat st;
+            if (fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+            is_dir = S_ISDIR(st.st_mode);
+            if (!is_dir && st.st_nlink > 1) {
+                link_add(w, &st);
+            } else {
+                w->totals.bytes += (unsigned long long)st.st_blocks * 512;
+            }
+        }
+
+        if (pool->pattern != NULL && fnmatch(pool->pattern, name, 0) == 0) {
+            out_path(w, path, name);
+        }
+
+        if (!is_dir) {
+            w->totals.files++;
+            continue;
+        }
+
+        //O_NOFOLLOW: never walk into a symlinked directory
+        int child_fd = openat(dir_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (child_fd < 0) {
+            continue;
+        }
+        char *child_path = path ? join_path(path, name) : NULL;
+
+        //hand the directory to the pool, unless too many fds are already
+        //parked in the deques, then read it right here instead
+        if (atomic_fetch_add(&pool->queued_fds, 1) < pool->fd_budget) {
+            atomic_fetch_add(&pool->pending, 1);
+            walk_item item = { child_fd, child_path };
+            if (deque_push(&w->deque, item) == 0) {
+                wake_idle(pool);
+                continue;
+            }
+            atomic_fetch_sub(&pool->pending, 1);
+        }
+        atomic_fetch_sub(&pool->queued_fds, 1);
+        walk_dir(w, child_fd, child_path);
+    }
+
+    closedir(dir);
+    free(path);
+}
+
+static void* worker_main(void *arg) {
+    walk_worker *w = arg;
+    walk_pool *pool = w->pool;
+    walk_item item;
+
+    while (1) {
+        if (deque_take(&w->deque, &item, 0) || steal(w, &item)) {
+            atomic_fetch_sub(&pool->queued_fds, 1);
+            walk_dir(w, item.fd, item.path);
+            //children were counted before this drops, so 0 means done
+            if (atomic_fetch_sub(&pool->pending, 1) == 1) {
+                pthread_mutex_lock(&pool->idle_lock);
+                pthread_cond_broadcast(&pool->idle_cond);
+                pthread_mutex_unlock(&pool->idle_lock);
+            }
+        } else if (atomic_load(&pool->pending) == 0) {
+            break;
+        } else {
+            wait_for_work(pool);
+        }
+    }
+    return NULL;
+}
+
+
+// ------------------------------ Entry point ------------------------------
+int walk_tree(const char *root, int need_stat, const char *pattern, walk_totals *totals) {
+    memset(totals, 0, sizeof(*totals));
+
+    struct stat st;
+    if (fstatat(AT_FDCWD, root, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        return -1;
+    }
+
+    //the root itself: counted and matched like any other entry
+    if (need_stat) {
+        totals->bytes += (unsigned long long)st.st_blocks * 512;
+    }
+    if (pattern != NULL) {
+        const char *base = strrchr(root, '/');
+        base = (base && base[1] != '\0') ? base + 1 : root;
+        if (fnmatch(pattern, base, 0) == 0) {
+            write(STDOUT_FILENO, root, strlen(root));
+            write(STDOUT_FILENO, "\n", 1);
+        }
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        totals->files = 1;
+        return 0;
+    }
+
+    int root_fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (root_fd < 0) {
+        return -1;
+    }
+
+    walk_pool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.need_stat = need_stat;
+    pool.pattern = pattern;
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    pool.num_workers = cores < 1 ? 1 : (cores > MAX_WORKERS ? MAX_WORKERS : (int)cores);
+
+    //leave half the fd limit to the rest of the shell
+    struct rlimit lim;
+    pool.fd_budget = 512;
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur != RLIM_INFINITY) {
+        pool.fd_budget = (int)(lim.rlim_cur / 2);
+    }
+
+    pool.workers = aligned_alloc(64, sizeof(walk_worker) * pool.num_workers);
+    if (pool.workers == NULL) {
+        close(root_fd);
+        return -1;
+    }
+    pthread_mutex_init(&pool.idle_lock, NULL);
+    pthread_cond_init(&pool.idle_cond, NULL);
+    memset(pool.workers, 0, sizeof(walk_worker) * pool.num_workers);
+    for (int i = 0; i < pool.num_workers; i++) {
+        pthread_mutex_init(&pool.workers[i].deque.lock, NULL);
+        pool.workers[i].pool = &pool;
+        pool.workers[i].seed = i + 1;
+    }
+
+    //seed worker 0 with the root, the rest start by stealing
+    atomic_store(&pool.pending, 1);
+    atomic_store(&pool.queued_fds, 1);
+    walk_item first = { root_fd, pattern ? strdup(root) : NULL };
+    deque_push(&pool.workers[0].deque, first);
+
+    int started = 0;
+    for (int i = 1; i < pool.num_workers; i++) {
+        if (pthread_create(&pool.workers[i].thread, NULL, worker_main, &pool.workers[i]) != 0) {
+            break;
+        }
+        started = i;
+    }
+    //the calling thread is worker 0
+    worker_main(&pool.workers[0]);
+    for (int i = 1; i <= started; i++) {
+        pthread_join(pool.workers[i].thread, NULL);
+    }
+
+    //combine per-thread results
+    size_t num_links = 0;
+    for (int i = 0; i < pool.num_workers; i++) {
+        num_links += pool.workers[i].num_links;
+    }
+    walk_link *links = num_links ? malloc(num_links * sizeof(walk_link)) : NULL;
+    num_links = 0;
+
+    for (int i = 0; i < pool.num_workers; i++) {
+        walk_worker *w = &pool.workers[i];
+        totals->bytes += w->totals.bytes;
+        totals->dirs += w->totals.dirs;
+        totals->files += w->totals.files;
+        if (links != NULL) {
+            memcpy(links + num_links, w->links, w->num_links * sizeof(walk_link));
+            num_links += w->num_links;
+        } else {
+            //no room to sort them: count every name, as link_add does
+            for (size_t j = 0; j < w->num_links; j++) {
+                totals->bytes += w->links[j].bytes;
+            }
+        }
+        out_flush(w);
+        free(w->links);
+        free(w->out);
+        free(w->deque.items);
+        pthread_mutex_destroy(&w->deque.lock);
+    }
+    free(pool.workers);
+    pthread_cond_destroy(&pool.idle_cond);
+    pthread_mutex_destroy(&pool.idle_lock);
+
+    //each hard-linked inode counts once no matter how many names it has
+    qsort(links, num_links, sizeof(walk_link), link_compare);
+    for (size_t i = 0; i < num_links; i++) {
+        if (i == 0 || link_compare(&links[i - 1], &links[i]) != 0) {
+            totals->bytes += links[i].bytes;
+        }
+    }
+    free(links);
+
+    return 0;
+}
@@ -0,0 +1,33 @@
+/*
+ *	Purpose: Parallel directory walker used by the du and find builtins.
+ *			 The tree is traversed with openat()/fdopendir()/fstatat() by a
+ *			 pool of threads (one per online core). Each thread owns a deque
+ *			 of directories still to read and steals from the others when its
+ *			 own deque runs dry. Every thread keeps its own totals and output
+ *			 buffer, they are only combined once all threads have finished.
+ *
+ */
+
+#ifndef TREE_WALK_H_
+#define TREE_WALK_H_
+
+// totals gathered over a whole walk
+typedef struct
+{
+    //disk usage in bytes (st_blocks * 512), only filled when stat is requested
+    unsigned long long bytes;
+    //number of directories read
+    unsigned long long dirs;
+    //number of non-directory entries seen
+    unsigned long long files;
+}walk_totals;
+
+//walk the tree rooted at root.
+//need_stat: fstatat() every entry so totals->bytes is filled (du)
+//pattern:   if not NULL, every path whose last component matches the
+//           fnmatch() pattern is written to stdout, one per line (find)
+//returns 0 on success, -1 if root cannot be opened
+int walk_tree(const char *root, int need_stat, const char *pattern, walk_totals *totals);
+
+
+#endif /* TREE_WALK_H_ */
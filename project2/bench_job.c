@@ -0,0 +1,85 @@
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+/*
+ * benchmark workload for bench_script.sh
+ *   bench_job cpu <ms>   spins like cpubound until it used <ms> of CPU
+ *   bench_job io <ms>    writes to /dev/null like iobound, but sleeps
+ *                        IO_SLEEP_MS after every IO_BURST_MS of CPU, as
+ *                        if waiting on a device, until it used <ms> of CPU
+ * when done it appends one line to $BENCH_LOG:
+ *   pid type start_ns end_ns cpu_ns blocked_ns voluntary involuntary
+ * (CLOCK_REALTIME, so the script can compare it with its own clock)
+ */
+
+#define IO_BURST_MS 1
+#define IO_SLEEP_MS 2
+
+long long clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+    long long start = clock_ns(CLOCK_REALTIME);
+    int i, j;
+
+    if (argc != 3 || (strcmp(argv[1], "cpu") != 0 && strcmp(argv[1], "io") != 0)) {
+        fprintf(stderr, "Usage: %s cpu|io <ms>\n", argv[0]);
+        exit(1);
+    }
+    int io = strcmp(argv[1], "io") == 0;
+    long long budget = atol(argv[2]) * 1000000LL;
+    long long blocked = 0;
+    long long next_sleep = IO_BURST_MS * 1000000LL;
+    int devnull = open("/dev/null", O_WRONLY);
+    char line[1001];
+    memset(line, 'A', sizeof(line) - 1);
+    line[sizeof(line) - 1] = '\n';
+
+    while (clock_ns(CLOCK_PROCESS_CPUTIME_ID) < budget) {
+        if (io) {
+            write(devnull, line, sizeof(line));
+            if (clock_ns(CLOCK_PROCESS_CPUTIME_ID) >= next_sleep) {
+                struct timespec nap = { 0, IO_SLEEP_MS * 1000000L };
+                long long before = clock_ns(CLOCK_REALTIME);
+                nanosleep(&nap, NULL);
+                blocked += clock_ns(CLOCK_REALTIME) - before;
+                next_sleep += IO_BURST_MS * 1000000LL;
+            }
+        } else {
+            i = 0;
+            for (j = 0; j < 100; j++) {
+                i = i + (i * 2);
+            }
+        }
+    }
+    close(devnull);
+
+    long long end = clock_ns(CLOCK_REALTIME);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    const char *log = getenv("BENCH_LOG");
+    if (log == NULL) return 0;
+    //one write() per line: O_APPEND keeps lines from different jobs whole
+    char result[256];
+    int len = snprintf(result, sizeof(result), "%d %s %lld %lld %lld %lld %ld %ld\n",
+                       getpid(), argv[1], start, end, clock_ns(CLOCK_PROCESS_CPUTIME_ID), blocked,
+                       usage.ru_nvcsw, usage.ru_nivcsw);
+    int fd = open(log, O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd == -1) {
+        perror("BENCH_LOG");
+        exit(1);
+    }
+    write(fd, result, len);
+    close(fd);
+    return 0;
+}
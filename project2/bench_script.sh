@@ -0,0 +1,208 @@
+#!/bin/bash
+
+# scheduler benchmark: runs mixes of CPU bound and I/O bound jobs under
+# every MCP part/policy and reports, per run:
+#   turnaround, response and wait time (mean, ms, from MCP launch)
+#   Jain's fairness index of the CPU rate each job got (cpu / turnaround)
+#   context switches of the jobs themselves (every I/O sleep is one: this
+#   follows the workload, not the scheduler)
+#   switches the MCP made (a core handed to another job), the MCP's own
+#   CPU time, and that time per switch; part5 only, counted from its
+#   --trace (so its flusher thread is in the MCP's CPU time), '-' for
+#   part1-4, which have no trace
+#
+# usage: ./bench_script.sh [-t <job ms>] [-q <quantum ms>] [-j <cores>] [job counts...]
+#   defaults: -t 200 -q 50 -j 1, job counts 10 100 1000
+#
+# relies on the Makefile in MCP_DIR (default raynap_proj2) and bench_job.c
+# part2-4 keep their jobs in 64 entry tables: skipped above 64 jobs
+# results also go to bench_results.csv
+
+MCP_DIR="${MCP_DIR:-raynap_proj2}"
+BENCH_DIR="bench_project2"
+RESULTS="bench_results.csv"
+
+JOB_MS="200"
+QUANTUM_MS="50"
+CORES="1"
+
+# MCPs to compare: "<binary> <options>"
+MCPS=(
+    "part1"
+    "part2"
+    "part3 -q QUANTUM"
+    "part4 -q QUANTUM"
+    "part5 -q QUANTUM -j CORES -p heuristic"
+    "part5 -q QUANTUM -j CORES -p rr"
+    "part5 -q QUANTUM -j CORES -p mlfq"
+    "part5 -q QUANTUM -j CORES -p cfs"
+    "part5 -q QUANTUM -j CORES -p dag"
+    "part5 -q QUANTUM -j CORES -p stride"
+    "part5 -q QUANTUM -j CORES -p lottery"
+)
+
+
+setup_bench_environment() {
+    rm -drf $BENCH_DIR
+    mkdir $BENCH_DIR
+    for part in part1 part2 part3 part4 part5; do
+        cp $MCP_DIR/$part $BENCH_DIR
+    done
+    cp bench_job $BENCH_DIR
+}
+
+
+cleanup_bench_environment() {
+    rm -drf $BENCH_DIR
+}
+
+# job file of $1 jobs, alternating CPU bound and I/O bound
+make_job_file() {
+    for ((i = 0; i < $1; i++)); do
+        if ((i % 2 == 0)); then
+            echo "./bench_job cpu $JOB_MS"
+        else
+            echo "./bench_job io $JOB_MS"
+        fi
+    done
+}
+
+# CPU time (ms) of every child this shell has waited for so far, into
+# CHILDREN_CPU_MS (times has to run in this shell, not in a $(...) subshell)
+children_cpu_ms() {
+    times > times.txt
+    CHILDREN_CPU_MS=$(awk 'NR == 2 {
+        total = 0
+        for (f = 1; f <= 2; f++) {
+            split($f, t, "m")
+            sub("s", "", t[2])
+            total += t[1] * 60000 + t[2] * 1000
+        }
+        printf "%d\n", total
+    }' times.txt)
+}
+
+# run one MCP on a job file and print its report line
+# $1: job count, $2: MCP command line
+run_benchmark() {
+    local jobs=$1
+    local mcp=${2//QUANTUM/$QUANTUM_MS}
+    mcp=${mcp//CORES/$CORES}
+    local binary=${mcp%% *}
+
+    if [ "$binary" != "part1" ] && [ "$binary" != "part5" ] && ((jobs > 64)); then
+        printf "%-6s %-34s skipped (64 jobs at most)\n" "$jobs" "$mcp"
+        return
+    fi
+
+    make_job_file $jobs > jobs.txt
+    rm -f results.log trace.csv
+    local trace=""
+    if [ "$binary" == "part5" ]; then
+        trace="--trace trace.csv"
+    fi
+    export BENCH_LOG="$PWD/results.log"
+    # generous: every job back to back, four times over
+    local limit=$((jobs * JOB_MS * 4 / 1000 / CORES + 60))
+
+    children_cpu_ms
+    local cpu_before=$CHILDREN_CPU_MS
+    local t0=$(date +%s%N)
+    timeout $limit ./$mcp -f jobs.txt $trace > /dev/null 2>&1
+    local status=$?
+    # part1 may leave running jobs behind: wait for their lines
+    while [ $(cat results.log 2>/dev/null | wc -l) -lt $jobs ] &&
+          (( $(date +%s%N) - t0 < limit * 1000000000 )); do
+        sleep 0.1
+    done
+    children_cpu_ms
+    local cpu_after=$CHILDREN_CPU_MS
+
+    if [ $status -eq 124 ]; then
+        printf "%-6s %-34s timed out after %d s\n" "$jobs" "$mcp" "$limit"
+        return
+    fi
+
+    # trace columns: time_ns,cpu,reason,stopped_job,stopped_pid,started_job,...
+    local mcp_switches=-1
+    if [ -n "$trace" ] && [ -f trace.csv ]; then
+        mcp_switches=$(awk -F, 'NR > 1 && $6 != "" && $6 != $4 { n++ } END { print n + 0 }' trace.csv)
+    fi
+
+    awk -v t0=$t0 -v jobs=$jobs -v mcp="$mcp" -v cpu_total=$((cpu_after - cpu_before)) \
+        -v mcp_switches=$mcp_switches -v csv="$RESULTS_PATH" '
+    {
+        turnaround = ($4 - t0) / 1e6
+        response = ($3 - t0) / 1e6
+        cpu = $5 / 1e6
+        wait = turnaround - cpu - $6 / 1e6
+        if (wait < 0) wait = 0
+        sum_turnaround += turnaround
+        sum_response += response
+        sum_wait += wait
+        sum_cpu += cpu
+        rate = cpu / turnaround
+        sum_rate += rate
+        sum_rate2 += rate * rate
+        job_switches += $7 + $8
+        done++
+    }
+    END {
+        if (done == 0) {
+            printf "%-6s %-34s no job finished\n", jobs, mcp
+            exit
+        }
+        jain = sum_rate * sum_rate / (done * sum_rate2)
+        overhead = cpu_total - sum_cpu
+        if (overhead < 0) overhead = 0
+        if (mcp_switches < 0) {
+            switches = "-"
+            per_switch = "-"
+        } else {
+            switches = mcp_switches
+            per_switch = mcp_switches > 0 ? sprintf("%.1f", overhead * 1000 / mcp_switches) : "0.0"
+        }
+        printf "%-6s %-34s %4d/%-5d %-11.1f %-11.1f %-11.1f %-6.3f %-9d %-9s %-10.1f %-8s\n",
+               jobs, mcp, done, jobs, sum_turnaround / done, sum_response / done, sum_wait / done,
+               jain, job_switches, switches, overhead, per_switch
+        printf "%d,%s,%d,%.1f,%.1f,%.1f,%.3f,%d,%s,%.1f,%s\n",
+               jobs, mcp, done, sum_turnaround / done, sum_response / done, sum_wait / done,
+               jain, job_switches, switches, overhead, per_switch >> csv
+    }' results.log
+}
+
+#------------------------------------
+
+while getopts "t:q:j:" opt; do
+    case $opt in
+        t) JOB_MS=$OPTARG ;;
+        q) QUANTUM_MS=$OPTARG ;;
+        j) CORES=$OPTARG ;;
+        *) echo "usage: $0 [-t <job ms>] [-q <quantum ms>] [-j <cores>] [job counts...]"; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+JOB_COUNTS=${@:-10 100 1000}
+
+make -C $MCP_DIR part1 part2 part3 part4 part5 > /dev/null || exit 1
+gcc bench_job.c -o bench_job || exit 1
+
+setup_bench_environment
+RESULTS_PATH="$PWD/$RESULTS"
+echo "jobs,mcp,done,turnaround_ms,response_ms,wait_ms,jain,job_ctx_switches,mcp_switches,mcp_cpu_ms,mcp_us_per_switch" > $RESULTS
+cd $BENCH_DIR
+
+echo "=== Scheduler benchmark: $JOB_MS ms of CPU per job, $QUANTUM_MS ms quantum, $CORES core(s) ==="
+printf "%-6s %-34s %-10s %-11s %-11s %-11s %-6s %-9s %-9s %-10s %-8s\n" \
+       "Jobs" "MCP" "Done" "Turn(ms)" "Resp(ms)" "Wait(ms)" "Jain" "JobCS" "MCPsw" "MCP(ms)" "us/sw"
+echo "-----------------------------------------------------------------------------------------------------------------------------------"
+for jobs in $JOB_COUNTS; do
+    for mcp in "${MCPS[@]}"; do
+        run_benchmark $jobs "$mcp"
+    done
+done
+
+cd ..
+cleanup_bench_environment
+echo ""
+echo "Results saved to $RESULTS"
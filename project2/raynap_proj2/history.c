@@ -0,0 +1,111 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "history.h"
+
+// what one command used last time
+typedef struct
+{
+    char *command;
+    long long cpu_ns;
+}history_entry;
+
+//kept sorted by command, so lookups are a binary search
+static history_entry *entries = NULL;
+static int num_entries = 0;
+static int entries_capacity = 0;
+
+//index of command in entries, or where it would go; *found is 1 if it is there
+static int find(const char *command, int *found) {
+    int low = 0;
+    int high = num_entries;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        int order = strcmp(entries[mid].command, command);
+        if (order == 0) {
+            *found = 1;
+            return mid;
+        }
+        if (order < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    *found = 0;
+    return low;
+}
+
+int history_load(const char *path) {
+    FILE *file = fopen(path, "r");
+    //no history yet: every estimate is unknown
+    if (file == NULL) return 0;
+
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t nread;
+    while ((nread = getline(&line, &len, file)) != -1) {
+        while (nread > 0 && (line[nread - 1] == '\n' || line[nread - 1] == '\r')) {
+            line[--nread] = '\0';
+        }
+        char *end;
+        double ms = strtod(line, &end);
+        if (end == line || *end != ' ' || ms < 0) continue;
+        history_update(end + 1, (long long)(ms * 1e6));
+    }
+    free(line);
+    fclose(file);
+    return 0;
+}
+
+long long history_lookup(const char *command) {
+    int found;
+    int k = find(command, &found);
+    return found ? entries[k].cpu_ns : -1;
+}
+
+void history_update(const char *command, long long cpu_ns) {
+    int found;
+    int k = find(command, &found);
+    if (found) {
+        entries[k].cpu_ns = cpu_ns;
+        return;
+    }
+    if (num_entries == entries_capacity) {
+        int capacity = entries_capacity ? entries_capacity * 2 : 64;
+        history_entry *grown = realloc(entries, capacity * sizeof(history_entry));
+        if (grown == NULL) {
+            perror("History");
+            exit(1);
+        }
+        entries = grown;
+        entries_capacity = capacity;
+    }
+    memmove(&entries[k + 1], &entries[k], (num_entries - k) * sizeof(history_entry));
+    entries[k].command = strdup(command);
+    if (entries[k].command == NULL) {
+        perror("History");
+        exit(1);
+    }
+    entries[k].cpu_ns = cpu_ns;
+    num_entries++;
+}
+
+int history_save(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) return -1;
+    for (int k = 0; k < num_entries; k++) {
+        fprintf(file, "%.3f %s\n", entries[k].cpu_ns / 1e6, entries[k].command);
+    }
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+void history_free(void) {
+    for (int k = 0; k < num_entries; k++) {
+        free(entries[k].command);
+    }
+    free(entries);
+    entries = NULL;
+    num_entries = entries_capacity = 0;
+}
@@ -0,0 +1,31 @@
+/*
+
+Job runtime history for the MCP's critical path estimates (part5 --history <file>)
+    - one line per command: "<cpu ms> <command line as written>"
+    - loaded before the input file is read, so each job's estimate is what
+      the same command used last time; unknown commands get -1
+    - every job that exits successfully records the CPU time it used, and
+      the file is rewritten (sorted by command) when the MCP is done
+
+*/
+
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+//read path if it exists, returns 0 (also for a missing file) or -1 with errno set
+int history_load(const char *path);
+
+//CPU time (ns) command used last time, -1 if unknown
+long long history_lookup(const char *command);
+
+//command just used cpu_ns of CPU time
+void history_update(const char *command, long long cpu_ns);
+
+//write every entry back to path, returns 0 or -1 with errno set
+int history_save(const char *path);
+
+//forget everything
+void history_free(void);
+
+
+#endif /* HISTORY_H_ */
@@ -0,0 +1,48 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "mcp_opts.h"
+
+long quantum_from_ms(const char *arg) {
+    //quantum given in milliseconds, 1 ms minimum
+    long usec = atol(arg) * 1000;
+    if (usec < 1000) {
+        fprintf(stderr, "Invalid quantum: '%s' (milliseconds, at least 1)\n", arg);
+        exit(1);
+    }
+    return usec;
+}
+
+void quantum_timerspec(long usec, struct itimerspec *its) {
+    memset(its, 0, sizeof(*its));
+    its->it_value.tv_sec = usec / 1000000;
+    its->it_value.tv_nsec = (usec % 1000000) * 1000;
+}
+
+char *parse_mcp_args(int argc, char *argv[], long *quantum_usec) {
+    char *input_path = NULL;
+    int opt;
+    int bad_option = 0;
+    //report bad options ourselves
+    opterr = 0;
+    while (!bad_option && (opt = getopt(argc, argv, "f:q:")) != -1) {
+        switch (opt) {
+            case 'f':
+                input_path = optarg;
+                break;
+            case 'q':
+                *quantum_usec = quantum_from_ms(optarg);
+                break;
+            default:
+                bad_option = 1;
+                break;
+        }
+    }
+    if (bad_option || input_path == NULL || optind != argc) {
+        fprintf(stderr, "Invalid use: incorrect number of parameters\n");
+        exit(1);
+    }
+    return input_path;
+}
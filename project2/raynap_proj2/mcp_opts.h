@@ -0,0 +1,28 @@
+/*
+
+Command line and quantum timer helpers shared by the MCPs (parts 3, 4 and 5)
+    - -q <ms> is parsed and checked the same way everywhere
+    - a quantum timer (timer_t or timerfd) is armed with a one-shot
+      itimerspec filled from microseconds
+    - parts 3 and 4 take the same "-f <file> [-q <ms>]" command line;
+      part5's has more options and keeps its own getopt_long loop
+
+*/
+
+#ifndef MCP_OPTS_H_
+#define MCP_OPTS_H_
+
+#include <time.h>
+
+//-q's argument (ms, 1 at least) in microseconds, exits with a message if invalid
+long quantum_from_ms(const char *arg);
+
+//fill its as a one-shot timer that fires after usec microseconds (0 disarms it)
+void quantum_timerspec(long usec, struct itimerspec *its);
+
+//parse "-f <file> [-q <ms>]", exits with a message if that is not the command line
+//returns the file, *quantum_usec is only set when -q is given
+char *parse_mcp_args(int argc, char *argv[], long *quantum_usec);
+
+
+#endif /* MCP_OPTS_H_ */
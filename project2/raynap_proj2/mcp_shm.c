@@ -0,0 +1,170 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mcp_shm.h"
+
+//writer side: the segment this process owns
+static mcp_shm *segment = NULL;
+static int segment_fd = -1;
+static char segment_name[256];
+
+//bytes needed for capacity jobs
+static size_t segment_size(uint32_t capacity) {
+    return sizeof(mcp_shm) + (size_t)capacity * sizeof(mcp_shm_job);
+}
+
+int mcp_shm_create(const char *name) {
+    snprintf(segment_name, sizeof(segment_name), "%s", name);
+    //O_EXCL: never take over a segment another MCP still publishes in
+    //(fails with EEXIST)
+    segment_fd = shm_open(segment_name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (segment_fd == -1) return -1;
+
+    uint32_t capacity = 64;
+    size_t size = segment_size(capacity);
+    if (ftruncate(segment_fd, size) == -1) return -1;
+    segment = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, segment_fd, 0);
+    if (segment == MAP_FAILED) {
+        segment = NULL;
+        return -1;
+    }
+
+    //ftruncate zero-fills: seq starts even, nothing published yet
+    segment->version = MCP_SHM_VERSION;
+    segment->size = size;
+    segment->capacity = capacity;
+    //magic last: readers can tell a half-made segment
+    __atomic_store_n(&segment->magic, MCP_SHM_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+
+mcp_shm *mcp_shm_begin(uint32_t num_jobs) {
+    //odd: readers now retry until mcp_shm_end
+    __atomic_store_n(&segment->seq, segment->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    if (num_jobs > segment->capacity) {
+        uint32_t capacity = segment->capacity;
+        while (capacity < num_jobs) capacity *= 2;
+        size_t old_size = segment->size;
+        size_t size = segment_size(capacity);
+        void *grown = MAP_FAILED;
+        if (ftruncate(segment_fd, size) == 0) {
+            grown = mremap(segment, old_size, size, MREMAP_MAYMOVE);
+        }
+        if (grown == MAP_FAILED) {
+            perror("Shared state");
+            exit(1);
+        }
+        segment = grown;
+        segment->size = size;
+        segment->capacity = capacity;
+    }
+    segment->num_jobs = num_jobs;
+    return segment;
+}
+
+void mcp_shm_end(void) {
+    //even again, after every write above is visible
+    __atomic_store_n(&segment->seq, segment->seq + 1, __ATOMIC_RELEASE);
+}
+
+void mcp_shm_destroy(void) {
+    if (segment == NULL) return;
+    __atomic_store_n(&segment->done, 1, __ATOMIC_RELEASE);
+    munmap(segment, segment->size);
+    close(segment_fd);
+    shm_unlink(segment_name);
+    segment = NULL;
+    segment_fd = -1;
+}
+
+
+int mcp_shm_attach(mcp_shm_reader *reader, const char *name) {
+    reader->map = NULL;
+    reader->fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    if (reader->fd == -1) return -1;
+
+    struct stat st;
+    if (fstat(reader->fd, &st) == -1 || (size_t)st.st_size < sizeof(mcp_shm)) {
+        close(reader->fd);
+        errno = EINVAL;
+        return -1;
+    }
+    reader->size = st.st_size;
+    const mcp_shm *map = mmap(NULL, reader->size, PROT_READ, MAP_SHARED, reader->fd, 0);
+    if (map == MAP_FAILED) {
+        close(reader->fd);
+        return -1;
+    }
+    reader->map = map;
+    return 0;
+}
+
+//map the segment again at its current (bigger) size
+static int reader_remap(mcp_shm_reader *reader, size_t size) {
+    const mcp_shm *map = mmap(NULL, size, PROT_READ, MAP_SHARED, reader->fd, 0);
+    if (map == MAP_FAILED) return -1;
+    munmap((void *)reader->map, reader->size);
+    reader->map = map;
+    reader->size = size;
+    return 0;
+}
+
+int mcp_shm_read(mcp_shm_reader *reader, mcp_shm_snapshot *snap) {
+    for (;;) {
+        const mcp_shm *map = reader->map;
+        if (__atomic_load_n(&map->magic, __ATOMIC_ACQUIRE) != MCP_SHM_MAGIC ||
+            map->version != MCP_SHM_VERSION) {
+            return -1;
+        }
+
+        uint32_t seq = __atomic_load_n(&map->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            //mid-update, the writer is done within microseconds
+            sched_yield();
+            continue;
+        }
+
+        size_t size = map->size;
+        uint32_t num_jobs = map->num_jobs;
+        if (size > reader->size) {
+            if (reader_remap(reader, size) != 0) return -1;
+            continue;
+        }
+        if (segment_size(num_jobs) > reader->size) continue;
+
+        if (num_jobs > snap->jobs_capacity) {
+            mcp_shm_job *grown = realloc(snap->jobs, num_jobs * sizeof(mcp_shm_job));
+            if (grown == NULL) return -1;
+            snap->jobs = grown;
+            snap->jobs_capacity = num_jobs;
+        }
+
+        memcpy(snap->title, map->title, sizeof(snap->title));
+        snap->title[sizeof(snap->title) - 1] = '\0';
+        snap->num_cores = map->num_cores < MCP_SHM_MAX_CORES ? map->num_cores : MCP_SHM_MAX_CORES;
+        memcpy(snap->cores, map->cores, snap->num_cores * sizeof(mcp_shm_core));
+        snap->num_jobs = num_jobs;
+        memcpy(snap->jobs, map->jobs, num_jobs * sizeof(mcp_shm_job));
+        snap->done = map->done;
+
+        //retry if the writer got in while we copied
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&map->seq, __ATOMIC_RELAXED) == seq) return 0;
+    }
+}
+
+void mcp_shm_detach(mcp_shm_reader *reader) {
+    if (reader->map != NULL) munmap((void *)reader->map, reader->size);
+    if (reader->fd >= 0) close(reader->fd);
+    reader->map = NULL;
+    reader->fd = -1;
+}
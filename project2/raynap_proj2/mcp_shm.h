@@ -0,0 +1,128 @@
+/*
+
+Scheduler state published in a named POSIX shared memory segment
+    - the MCP writes its job table into /dev/shm/<name> after scheduling
+      rounds, at most every 50 ms; anyone may map it read-only and look at
+      it at any rate, without a syscall into (or a lock shared with) the MCP
+    - consistency comes from a seqlock: the writer makes seq odd, writes,
+      and makes it even again; a reader copies what it needs and retries
+      if seq was odd or changed meanwhile. The writer never waits.
+    - the segment grows (ftruncate + mremap) as jobs are added; a reader
+      whose mapping is smaller than size remaps before copying
+    - layout is native byte order, fixed-size fields, versioned
+
+*/
+
+#ifndef MCP_SHM_H_
+#define MCP_SHM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+//"MCP1"
+#define MCP_SHM_MAGIC 0x3150434d
+#define MCP_SHM_VERSION 1
+#define MCP_SHM_MAX_CORES 256
+#define MCP_SHM_TITLE_LEN 64
+#define MCP_SHM_TYPE_LEN 8
+//runq_pos is exact up to here, a job further back shows this value
+#define MCP_SHM_RUNQ_RANKED 32
+
+// one job, in input file order
+typedef struct
+{
+    //0 once the job has exited
+    int32_t pid;
+    //'R' on a core now, 'W' waiting in a run queue, 'B' blocked (off the
+    //run queue until it wakes), 'X' exited,
+    //'P' not admitted yet (--max-active, after:), pid is 0 until then
+    char state;
+    //class the policy gave it: "CPU", "I/O", "Level 2", "Fair" ...
+    char type[MCP_SHM_TYPE_LEN];
+    //CPU of the core whose run queue holds it
+    int32_t cpu;
+    //jobs that run before it on that core (0: running or next), at most
+    //MCP_SHM_RUNQ_RANKED, -1 exited (or blocked, or not admitted)
+    int32_t runq_pos;
+    //length of its next (or current) slice
+    int64_t slice_us;
+    //CPU time used, as of its last slice or the last publish if running
+    int64_t cpu_ns;
+}mcp_shm_job;
+
+// one core: idle_ns so far, plus now - idle_since if idle_since != 0
+typedef struct
+{
+    int32_t cpu;
+    int64_t idle_ns;
+    int64_t idle_since;
+}mcp_shm_core;
+
+// start of the segment, jobs[capacity] follows
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    //seqlock: odd while the MCP is writing
+    uint32_t seq;
+    //1 once the MCP has finished (the segment is about to go away)
+    uint32_t done;
+    //bytes in the segment, grows with capacity
+    uint64_t size;
+    uint32_t capacity;
+    uint32_t num_jobs;
+    uint32_t num_cores;
+    char title[MCP_SHM_TITLE_LEN];
+    mcp_shm_core cores[MCP_SHM_MAX_CORES];
+    mcp_shm_job jobs[];
+}mcp_shm;
+
+// a reader's mapping of someone's segment
+typedef struct
+{
+    int fd;
+    const mcp_shm *map;
+    size_t size;
+}mcp_shm_reader;
+
+// a consistent copy of a segment
+typedef struct
+{
+    char title[MCP_SHM_TITLE_LEN];
+    uint32_t done;
+    uint32_t num_cores;
+    mcp_shm_core cores[MCP_SHM_MAX_CORES];
+    uint32_t num_jobs;
+    //grown by mcp_shm_read, free() when done
+    mcp_shm_job *jobs;
+    uint32_t jobs_capacity;
+}mcp_shm_snapshot;
+
+
+//writer (the MCP)
+//create segment name, returns 0 or -1 with errno set (EEXIST: it exists,
+//another MCP may still be using it)
+int mcp_shm_create(const char *name);
+
+//start an update with room for num_jobs jobs: returns the segment, seq is odd
+mcp_shm *mcp_shm_begin(uint32_t num_jobs);
+
+//end the update: seq is even again
+void mcp_shm_end(void);
+
+//mark the segment done, unmap and unlink it
+void mcp_shm_destroy(void);
+
+
+//readers
+//map segment name read-only, returns 0 or -1 with errno set
+int mcp_shm_attach(mcp_shm_reader *reader, const char *name);
+
+//copy a consistent snapshot into snap, returns 0 or -1 if the segment is
+//not an MCP segment (or from another version)
+int mcp_shm_read(mcp_shm_reader *reader, mcp_shm_snapshot *snap);
+
+void mcp_shm_detach(mcp_shm_reader *reader);
+
+
+#endif /* MCP_SHM_H_ */
@@ -0,0 +1,38 @@
+/*
+
+Dashboard for an MCP running elsewhere
+    - attaches to the shared memory segment a part5 MCP publishes its
+      scheduler state in, and draws it like the MCP's own monitor does
+    - usage: mcp_top <mcp pid | shm name>
+    - exits when that MCP finishes
+
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "monitor.h"
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Invalid use: incorrect number of parameters\n");
+        exit(1);
+    }
+
+    //a pid names the MCP's default segment
+    char name[256];
+    char *end;
+    long pid = strtol(argv[1], &end, 10);
+    if (*end == '\0' && pid > 0) {
+        snprintf(name, sizeof(name), "/mcp-%ld", pid);
+    } else {
+        snprintf(name, sizeof(name), "%s%s", argv[1][0] == '/' ? "" : "/", argv[1]);
+    }
+
+    if (monitor_run(name) != 0) {
+        perror(name);
+        exit(1);
+    }
+    return 0;
+}
@@ -0,0 +1,247 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include "proc_stat.h"
+#include "mcp_shm.h"
+#include "monitor.h"
+
+#define LINE_MAX_LEN 160
+#define SEPARATOR "-------------------------------------------------------------------------------------------------"
+
+//wakes the monitor early when it has to stop
+static pthread_mutex_t stop_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t stop_cond;
+static int stopping = 0;
+static pthread_t monitor_thread;
+
+// /proc/<pid>/stat of one row, reopened when the row's pid changes
+typedef struct
+{
+    pid_t pid;
+    int fd;
+}row_stat;
+
+// lines of text, one per screen row
+typedef struct
+{
+    char (*lines)[LINE_MAX_LEN];
+    int count;
+    int capacity;
+}line_buffer;
+
+//monitor only: its copy of the state and its /proc fds (per row)
+static mcp_shm_reader reader = { -1, NULL, 0 };
+static mcp_shm_snapshot view;
+static row_stat *row_stats = NULL;
+static int row_stats_capacity = 0;
+
+//monitor only: lines on screen now, lines of the frame being built
+static line_buffer screen = { NULL, 0, 0 };
+static line_buffer frame = { NULL, 0, 0 };
+static int frames_drawn = 0;
+
+//grow *array to hold count elements of size bytes
+static void ensure_capacity(void **array, int *capacity, int count, size_t size) {
+    if (count <= *capacity) return;
+    int grown_capacity = *capacity ? *capacity : 64;
+    while (grown_capacity < count) grown_capacity *= 2;
+    void *grown = realloc(*array, grown_capacity * size);
+    if (grown == NULL) {
+        perror("Monitor");
+        exit(1);
+    }
+    *array = grown;
+    *capacity = grown_capacity;
+}
+
+//append one formatted line to the frame being built
+static void frame_line(const char *format, ...) __attribute__((format(printf, 1, 2)));
+static void frame_line(const char *format, ...) {
+    ensure_capacity((void **)&frame.lines, &frame.capacity, frame.count + 1, LINE_MAX_LEN);
+    va_list args;
+    va_start(args, format);
+    vsnprintf(frame.lines[frame.count++], LINE_MAX_LEN, format, args);
+    va_end(args);
+}
+
+//format view (and /proc) into frame[]
+static void build_frame(void) {
+    frame.count = 0;
+    frame_line("%s", view.title);
+    frame_line("%s", SEPARATOR);
+    frame_line("%-10s %-20s %-8s %-4s %-10s %-10s %-10s %-8s %-7s %-5s",
+               "PID", "Name", "State", "CPU", "UTime(s)", "STime(s)", "Mem(KB)", "Type", "Slice", "Queue");
+    frame_line("%s", SEPARATOR);
+
+    //clock ticks per second
+    long clk_tck = sysconf(_SC_CLK_TCK);
+
+    //the per-row fds follow the row's pid: open on a new pid, close on exit
+    int old_capacity = row_stats_capacity;
+    ensure_capacity((void **)&row_stats, &row_stats_capacity, view.num_jobs, sizeof(row_stat));
+    for (int i = old_capacity; i < row_stats_capacity; i++) {
+        row_stats[i].pid = 0;
+        row_stats[i].fd = -1;
+    }
+
+    int pending = 0;
+    for (int i = 0; i < (int)view.num_jobs; i++) {
+        mcp_shm_job *row = &view.jobs[i];
+        row_stat *rs = &row_stats[i];
+        if (row->state == 'P') pending++;
+        if (rs->pid != row->pid) {
+            if (rs->fd >= 0) close(rs->fd);
+            rs->fd = row->pid != 0 ? proc_stat_open(row->pid) : -1;
+            rs->pid = row->pid;
+        }
+        //skip dead processes
+        proc_stat st;
+        if (row->pid == 0 || rs->fd < 0 || proc_stat_read(rs->fd, &st) != 0) continue;
+
+        char type[MCP_SHM_TYPE_LEN + 1];
+        memcpy(type, row->type, MCP_SHM_TYPE_LEN);
+        type[MCP_SHM_TYPE_LEN] = '\0';
+        char slice[24];
+        snprintf(slice, sizeof(slice), "%ldms", (long)(row->slice_us / 1000));
+        frame_line("%-10d %-20s %-8c %-4d %-10.2f %-10.2f %-10lu %-8s %-7s %d",
+                   (int)row->pid, st.comm, st.state, (int)row->cpu,
+                   (double)st.utime / clk_tck, (double)st.stime / clk_tck, st.vsize / 1024,
+                   type, slice, (int)row->runq_pos);
+    }
+    frame_line("%s", SEPARATOR);
+
+    //time each core sat on a blocked job or had nothing to run
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    long long now = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    char idle_line[LINE_MAX_LEN] = "Idle(s):";
+    size_t used = strlen(idle_line);
+    for (int c = 0; c < (int)view.num_cores && used < sizeof(idle_line); c++) {
+        long long idle = view.cores[c].idle_ns;
+        if (view.cores[c].idle_since != 0) idle += now - view.cores[c].idle_since;
+        used += snprintf(idle_line + used, sizeof(idle_line) - used, "  cpu%d %.2f", view.cores[c].cpu, idle / 1e9);
+    }
+    frame_line("%s", idle_line);
+    //jobs held back by --max-active
+    if (pending > 0) frame_line("Pending: %d job(s) waiting for admission", pending);
+}
+
+//write the lines of frame that differ from screen, then swap them
+static void draw_frame(void) {
+    int full = frames_drawn++ % MONITOR_FULL_REDRAW == 0;
+    //worst case: every line plus its cursor move and erase
+    size_t size = (size_t)(frame.count + 2) * (LINE_MAX_LEN + 32);
+    char *out = malloc(size);
+    if (out == NULL) return;
+    size_t len = 0;
+
+    if (full) {
+        len += snprintf(out + len, size - len, "\033[H\033[J");
+    }
+    for (int k = 0; k < frame.count; k++) {
+        if (!full && k < screen.count && strcmp(frame.lines[k], screen.lines[k]) == 0) continue;
+        //move to line k+1, draw it, erase what is left of the old line
+        len += snprintf(out + len, size - len, "\033[%d;1H%s\033[K", k + 1, frame.lines[k]);
+    }
+    if (!full && frame.count < screen.count) {
+        //the table got shorter: erase everything below it
+        len += snprintf(out + len, size - len, "\033[%d;1H\033[J", frame.count + 1);
+    }
+    //park the cursor under the table
+    len += snprintf(out + len, size - len, "\033[%d;1H", frame.count + 1);
+
+    for (size_t done = 0; done < len; ) {
+        ssize_t n = write(STDOUT_FILENO, out + done, len - done);
+        if (n <= 0) break;
+        done += n;
+    }
+    free(out);
+
+    line_buffer swap = screen;
+    screen = frame;
+    frame = swap;
+}
+
+//draw until told to stop or the MCP is done
+static void monitor_loop(void) {
+    for (;;) {
+        pthread_mutex_lock(&stop_lock);
+        if (!stopping) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_nsec += MONITOR_INTERVAL_MS * 1000000L;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+            deadline.tv_nsec %= 1000000000L;
+            pthread_cond_timedwait(&stop_cond, &stop_lock, &deadline);
+        }
+        int stop = stopping;
+        pthread_mutex_unlock(&stop_lock);
+
+        if (mcp_shm_read(&reader, &view) != 0) break;
+        build_frame();
+        draw_frame();
+        if (stop || view.done) break;
+    }
+}
+
+//set up the stop condition and map the segment
+static int monitor_open(const char *shm_name) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&stop_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    return mcp_shm_attach(&reader, shm_name);
+}
+
+//give back everything the monitor holds
+static void monitor_close(void) {
+    for (int i = 0; i < row_stats_capacity; i++) {
+        if (row_stats[i].fd >= 0) close(row_stats[i].fd);
+    }
+    free(row_stats);
+    row_stats = NULL;
+    row_stats_capacity = 0;
+    free(screen.lines);
+    free(frame.lines);
+    free(view.jobs);
+    mcp_shm_detach(&reader);
+}
+
+static void *monitor_main(void *arg) {
+    (void)arg;
+    monitor_loop();
+    return NULL;
+}
+
+void monitor_start(const char *shm_name) {
+    if (monitor_open(shm_name) != 0) {
+        perror("Monitor");
+        exit(1);
+    }
+    if (pthread_create(&monitor_thread, NULL, monitor_main, NULL) != 0) {
+        perror("Monitor thread");
+        exit(1);
+    }
+}
+
+void monitor_stop(void) {
+    pthread_mutex_lock(&stop_lock);
+    stopping = 1;
+    pthread_cond_signal(&stop_cond);
+    pthread_mutex_unlock(&stop_lock);
+    pthread_join(monitor_thread, NULL);
+    monitor_close();
+}
+
+int monitor_run(const char *shm_name) {
+    if (monitor_open(shm_name) != 0) return -1;
+    monitor_loop();
+    monitor_close();
+    return 0;
+}
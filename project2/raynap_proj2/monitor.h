@@ -0,0 +1,34 @@
+/*
+
+MCP dashboard
+    - reads the scheduler state the MCP publishes in shared memory
+      (mcp_shm.h), like any other observer, so the scheduler never
+      formats or prints and never waits for the dashboard
+    - runs as a thread inside the MCP (monitor_start), or on its own in
+      another process (monitor_run, see mcp_top.c)
+    - wakes every MONITOR_INTERVAL_MS, takes a seqlock snapshot, samples
+      /proc/<pid>/stat through its own fds and redraws only the screen
+      lines that changed, one write() per frame
+    - every MONITOR_FULL_REDRAW frames the whole screen is redrawn, to
+      repair anything the jobs themselves printed over it
+
+*/
+
+#ifndef MONITOR_H_
+#define MONITOR_H_
+
+#define MONITOR_INTERVAL_MS 250
+#define MONITOR_FULL_REDRAW 20
+
+//start the monitor thread on shared memory segment shm_name
+void monitor_start(const char *shm_name);
+
+//draw one last frame and stop the thread
+void monitor_stop(void);
+
+//draw shm_name in this thread until its MCP is done
+//returns 0, or -1 if the segment cannot be opened
+int monitor_run(const char *shm_name);
+
+
+#endif /* MONITOR_H_ */
@@ -3,6 +3,7 @@
 MCP Schedules Processes
 Round Robin scheduling using SIGALRM
     - processes taking turns (unlike part 2)
+    - quantum set with -q <ms> (default 1000)
 
 */
 
@@ -14,6 +15,8 @@ Round Robin scheduling using SIGALRM
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <signal.h>
+#include <time.h>
+#include "mcp_opts.h"
 
 //initialize global variables
 //signal handler cannot access main's local variable
@@ -22,6 +25,19 @@ int total_processes = 0;
 int current_process_index = -1;
 int has_started[64] = {0};
 
+//quantum length in microseconds, set with -q <ms> (default 1 second)
+long quantum_usec = 1000000;
+//CLOCK_MONOTONIC timer that raises SIGALRM when the current slice is over
+timer_t quantum_timer;
+
+//arm the quantum timer (one shot) for usec microseconds
+//replaces alarm(), which only counts whole seconds
+void set_quantum(long usec) {
+    struct itimerspec its;
+    quantum_timerspec(usec, &its);
+    timer_settime(quantum_timer, 0, &its, NULL);
+}
+
 //signal handler: scheduler
 //runs every time the alarm goes off
 void schedule_handler(int signum) {
@@ -72,16 +88,14 @@ void schedule_handler(int signum) {
     }
 
     //resent timer for next time slice
-    alarm(1);
+    set_quantum(quantum_usec);
 }
 
 int main(int argc, char *argv[]) {
-    if (argc!= 3) {
-        fprintf(stderr, "Incalid use: incorrect number of parameters\n");
-        exit(1);
-    }
+    //parse "-f <file> [-q <ms>]"
+    char *input_path = parse_mcp_args(argc, argv, &quantum_usec);
 
-    FILE *file = fopen(argv[2], "r");
+    FILE *file = fopen(input_path, "r");
     if (!file) {
         perror("Error opening file");
         exit(1);
@@ -91,6 +105,16 @@ int main(int argc, char *argv[]) {
     //link SIGALRM to function 'schedule_handler'
     signal(SIGALRM, schedule_handler);
 
+    //one timer for the whole run, each slice re-arms it
+    struct sigevent sev;
+    memset(&sev, 0, sizeof(sev));
+    sev.sigev_notify = SIGEV_SIGNAL;
+    sev.sigev_signo = SIGALRM;
+    if (timer_create(CLOCK_MONOTONIC, &sev, &quantum_timer) == -1) {
+        perror("timer_create");
+        exit(1);
+    }
+
     char *line = NULL;
     size_t len = 0;
     ssize_t nread;
@@ -113,6 +137,12 @@ int main(int argc, char *argv[]) {
 
         if (args[0] == NULL) continue;
 
+        //fixed-size tables: refuse to overflow them (part5 has no limit)
+        if (total_processes == 64) {
+            fprintf(stderr, "Too many jobs: only the first 64 are run\n");
+            break;
+        }
+
         pid_t pid = fork();
 
         if (pid < 0) {
@@ -3,6 +3,8 @@
 MCP reads files and displays stats
 Monitoring processes
     - by reading /proc
+    - quantum set with -q <ms> (default 1000)
+    - /proc/<pid>/stat is opened once per job and re-read with pread()
 
 */
 
@@ -12,14 +14,32 @@ Monitoring processes
 #include <string.h>
 #include <unistd.h>
 #include <signal.h>
+#include <time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include "proc_stat.h"
+#include "mcp_opts.h"
 
 //global variables
 pid_t pids[64];
 int total_processes = 0;
 int current_process_index = -1; 
 int has_started[64] = {0}; 
+//open /proc/<pid>/stat of each job, -1 once it has exited
+int stat_fds[64];
+
+//quantum length in microseconds, set with -q <ms> (default 1 second)
+long quantum_usec = 1000000;
+//CLOCK_MONOTONIC timer that raises SIGALRM when the current slice is over
+timer_t quantum_timer;
+
+//arm the quantum timer (one shot) for usec microseconds
+//replaces alarm(), which only counts whole seconds
+void set_quantum(long usec) {
+    struct itimerspec its;
+    quantum_timerspec(usec, &its);
+    timer_settime(quantum_timer, 0, &its, NULL);
+}
 
 //helper function: read and print from /proc
 //satisfies monitoring requirement
@@ -39,63 +59,21 @@ void print_process_info() {
     //skip dead processes
     for (int i = 0; i < total_processes; i++) {
         if (pids[i] == 0) continue;
-        char path[256];
-        snprintf(path, sizeof(path), "/proc/%d/stat", pids[i]);
-
-        FILE *f = fopen(path, "r");
-        if (!f) {
+        //re-read the stat file kept open since fork
+        proc_stat st;
+        if (stat_fds[i] < 0 || proc_stat_read(stat_fds[i], &st) != 0) {
             // Process dead before checked
             continue;
         }
 
-        // Variables for parsed data
-        int pid;
-        char comm[256];
-        char state;
-        int ppid, pgrp, session, tty_nr, tpgid;
-        unsigned int flags;
-        unsigned long minflt, cminflt, majflt, cmajflt;
-        //user Time, system Time
-        unsigned long utime, stime; 
-        long cutime, cstime, priority, nice, num_threads, itrealvalue;
-        unsigned long long starttime;
-        //cirtual memory size
-        unsigned long vsize;
-
-        //scan file
-        //fields needed: 2(comm), 3(state), 14(utime), 15(stime), 23(vsize)
-        fscanf(f, "%d %s %c %d %d %d %d %d %u %lu %lu %lu %lu %lu %lu %ld %ld %ld %ld %ld %ld %llu %lu",
-               &pid, comm, &state, &ppid, &pgrp, &session, &tty_nr, &tpgid, &flags,
-               &minflt, &cminflt, &majflt, &cmajflt, 
-                // 14: User time (ticks)
-               &utime,
-               // 15: System time (ticks)
-               &stime,
-               &cutime, &cstime, &priority, &nice, &num_threads, &itrealvalue, &starttime, 
-               // 23: Virtual memory (bytes)
-               &vsize);  
-
-        fclose(f);
-
-        // Parse command name
-        //remove parenthesis
-        char *name_clean = comm;
-        if (comm[0] == '(') {
-            name_clean++;
-            size_t len = strlen(name_clean);
-            if (len > 0 && name_clean[len-1] == ')') {
-                name_clean[len-1] = '\0';
-            }
-        }
-
         //convert ticks to seconds
-        double u_cpu = (double)utime / clk_tck;
-        double s_cpu = (double)stime / clk_tck;
+        double u_cpu = (double)st.utime / clk_tck;
+        double s_cpu = (double)st.stime / clk_tck;
         //convert bytes to kb
-        unsigned long mem_kb = vsize / 1024;
+        unsigned long mem_kb = st.vsize / 1024;
 
         printf("%-10d %-20s %-10c %-10.2f %-10.2f %-10lu\n", 
-               pids[i], name_clean, state, u_cpu, s_cpu, mem_kb);
+               pids[i], st.comm, st.state, u_cpu, s_cpu, mem_kb);
     }
     printf("---------------------------------------------------------------------------\n");
 }
@@ -110,6 +88,8 @@ void schedule_handler(int signum) {
         for (int i = 0; i < total_processes; i++) {
             if (pids[i] == finished_pid) {
                 pids[i] = 0;
+                close(stat_fds[i]);
+                stat_fds[i] = -1;
             }
         }
     }
@@ -146,20 +126,28 @@ void schedule_handler(int signum) {
         kill(pids[current_process_index], SIGCONT);
     }
 
-    alarm(1);
+    set_quantum(quantum_usec);
 }
 
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        fprintf(stderr, "Invalid use: incorrect number of parameters\n");
-        exit(1);
-    }
-    
-    FILE *file = fopen(argv[2], "r");
+    //parse "-f <file> [-q <ms>]"
+    char *input_path = parse_mcp_args(argc, argv, &quantum_usec);
+
+    FILE *file = fopen(input_path, "r");
     if (!file) { perror("Error opening file"); exit(1); }
 
     signal(SIGALRM, schedule_handler);
 
+    //one timer for the whole run, each slice re-arms it
+    struct sigevent sev;
+    memset(&sev, 0, sizeof(sev));
+    sev.sigev_notify = SIGEV_SIGNAL;
+    sev.sigev_signo = SIGALRM;
+    if (timer_create(CLOCK_MONOTONIC, &sev, &quantum_timer) == -1) {
+        perror("timer_create");
+        exit(1);
+    }
+
     char *line = NULL;
     size_t len = 0;
     ssize_t nread;
@@ -180,6 +168,12 @@ int main(int argc, char *argv[]) {
 
         if (args[0] == NULL) continue;
 
+        //fixed-size tables: refuse to overflow them (part5 has no limit)
+        if (total_processes == 64) {
+            fprintf(stderr, "Too many jobs: only the first 64 are run\n");
+            break;
+        }
+
         pid_t pid = fork();
 
         if (pid < 0) { perror("Fork Failed"); exit(1); }
@@ -196,6 +190,7 @@ int main(int argc, char *argv[]) {
             exit(1);
         }
         else {
+            stat_fds[total_processes] = proc_stat_open(pid);
             pids[total_processes++] = pid;
         }
     }
@@ -2,11 +2,13 @@
 
 Making a SMART schedular
 inspecting behavior and adjusting time slices accordingly
-
-requires heuristic: rules
-    - is process CPU or IO bound
-    - if usertime > systemtime: CPU bound
-    - o/w IO bound
+    - scheduling policy set with -p <name>: heuristic (default, CPU bound
+      jobs get 2 quanta, I/O bound 1), rr, mlfq, cfs, dag, stride, lottery
+    - quantum set with -q <ms> (default 1000), cores with -j <cores>
+    - an input line may start with options: weight:, nice:, tickets:,
+      after:<id>, at:<ms>
+    - --simulate <workload> runs the same scheduler in virtual time,
+      --trace <file> records every switch
 
 */
 
@@ -16,230 +18,2256 @@ requires heuristic: rules
 #include <string.h>
 #include <unistd.h>
 #include <signal.h>
+#include <time.h>
+#include <errno.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <getopt.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <sys/syscall.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdint.h>
+#include "proc_stat.h"
+#include "mcp_shm.h"
+#include "monitor.h"
+#include "trace.h"
+#include "sim.h"
+#include "history.h"
+#include "mcp_opts.h"
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+#ifndef SYS_pidfd_send_signal
+#define SYS_pidfd_send_signal 424
+#endif
+#ifndef P_PIDFD
+#define P_PIDFD 3
+#endif
+
+//event loop: epoll waits on the slots' timerfds, signalfd (SIGCHLD), one
+//pidfd per child (readable once it exited), the arrival timerfd and a
+//streamed -f FIFO, each tagged in data.u64 with (event type << 32) | slot
+//or job index; no work is done inside signal handlers
+#define EV_TIMER 0
+#define EV_SIGNAL 1
+#define EV_JOB 2
+#define EV_ARRIVAL 3
+#define EV_INPUT 4
+#define EV_TAG(type, index) (((uint64_t)(type) << 32) | (uint32_t)(index))
+#define EV_TYPE(tag) ((int)((tag) >> 32))
+#define EV_INDEX(tag) ((int)((tag) & 0xffffffff))
+
+//MLFQ: level k gets a slice of q << k, the highest non-empty level runs
+//first; a job moves down after using at least half its slice, up after
+//less, and everyone is boosted back to level 0 every MLFQ_BOOST_QUANTA
+//base quanta
+#define MLFQ_LEVELS 4
+#define MLFQ_BOOST_QUANTA 32
+
+//heuristic: per slice, syscalls per ms on the CPU, the fraction of the
+//slice spent blocked and voluntary switches per ms are smoothed with an
+//EWMA (the newest slice weighs HEUR_EWMA_ALPHA); any of them over its
+//HEUR_IO_ threshold makes the job I/O bound
+#define HEUR_EWMA_ALPHA 0.5
+#define HEUR_IO_SYSCALLS_PER_MS 5.0
+#define HEUR_IO_BLOCKED 0.5
+#define HEUR_IO_SWITCHES_PER_MS 0.1
+
+//how often the shared state is published at most, well under the
+//monitor's MONITOR_INTERVAL_MS
+#define PUBLISH_INTERVAL_MS 50
+
+//width of the report tables
+#define SEPARATOR "---------------------------------------------------------------------------"
+
+//CFS: weight of a nice 0 job
+#define NICE_0_WEIGHT 1024
+
+//DAG: after:<id> ids count the jobs of the file from 0 (as the trace
+//numbers them) and must be earlier jobs, so the dependencies always form
+//a DAG, at most MAX_AFTER per line; if one fails, every job after it is
+//reported and never runs
+#define MAX_AFTER 16
+
+//STRIDE and LOTTERY: over time each job on a core gets CPU in proportion
+//to its tickets (DEFAULT_TICKETS without tickets:<n>); a stride job's pass
+//advances by STRIDE1 / tickets per quantum of CPU, and the lottery
+//generator is seeded with a constant when simulating, so a run can be repeated
+#define DEFAULT_TICKETS 100
+#define STRIDE1 (1 << 20)
+
+// one line of the input file
+typedef struct
+{
+    //0 until the job is admitted, and again once it has been reaped
+    pid_t pid;
+    //1 until it is admitted: waiting for its arrival, the jobs it is
+    //after, or room under --max-active
+    int pending;
+    //command to run, kept until the job is spawned (NULL after, and when simulating)
+    char **argv;
+    //-1 if pidfd_open is not supported
+    int pidfd;
+    //open /proc/<pid>/stat for the monitor, -1 if it could not be opened
+    int stat_fd;
+    //heuristic: open io/schedstat/status files of the job
+    proc_activity_fds act_fds;
+    //heuristic: counters and CLOCK_MONOTONIC (ns) at the start of the slice
+    proc_activity slice_act;
+    long long slice_wall_start;
+    int slice_sampled;
+    //heuristic: smoothed syscalls/ms, blocked fraction, switches/ms
+    //(slices_seen == 0: no slice measured yet)
+    int slices_seen;
+    double ewma_syscall_rate;
+    double ewma_blocked;
+    double ewma_switch_rate;
+    int has_started;
+    //time slice (microseconds)
+    long time_slice;
+    //"CPU" or "I/O" (heuristic), "Level k" (mlfq)
+    char *proc_type;
+    //priority level, always 0 for the heuristic policy
+    int level;
+    //CPU-time clock of the child, has_cpu_clock is 0 if unavailable
+    clockid_t cpu_clock;
+    int has_cpu_clock;
+    //CPU time (ns) the job had when its current slice started
+    long long slice_cpu_start;
+    //CFS: share of the CPU (weight:/nice: in the input file)
+    int weight;
+    //STRIDE and LOTTERY: share of the CPU (tickets: in the input file)
+    int tickets;
+    //LOTTERY: index in its slot's lottery[], -1 if not in it
+    int lottery_pos;
+    //CFS: CPU time scaled by NICE_0_WEIGHT / weight (ns)
+    //STRIDE: the pass, one stride (STRIDE1 / tickets) per quantum of CPU
+    long long vruntime;
+    //CFS: index in its slot's heaps (HEAP_RUN, HEAP_VRUNTIME), -1 if not in it
+    int heap_pos[2];
+    //CPU time (ns) when last measured, for the shared state
+    long long cpu_ns;
+    //DAG: jobs that are after this one, and how many of the jobs this one
+    //is after have not exited yet
+    int *dependents;
+    int num_dependents;
+    int deps_left;
+    //DAG: 1 once it is there to be admitted (simulating: once it arrived)
+    int arrived;
+    //DAG: 1 if a job it is after failed, it never runs
+    int cancelled;
+    //DAG: estimated CPU time (ns, from --history), the longest chain of
+    //estimates among the jobs after it, and what is left of the two
+    //together: the critical path through this job
+    long long estimate_ns;
+    long long path_tail_ns;
+    long long path_left_ns;
+    //--history: the command line as written, NULL without it
+    char *command;
+    //DAG: order it joined the admission queue in, ties go to the first
+    long admit_seq;
+    //ns after MCP start it arrives at: its at:<ms>, but never before it was read
+    long long arrival_ns;
+    //ns after MCP start it first ran (-1: not yet) and exited, for the report
+    long long first_run_ns;
+    long long finish_ns;
+    //DAG: 0 until it is gone, then 1 if it exited with status 0, -1 if it
+    //failed or never ran
+    int outcome;
+    //slot (core) whose run queue holds this job
+    int slot;
+    //1 while it sleeps in the kernel: stopped, off the run queue, on its
+    //slot's parked list, until a probe sees it wake
+    int blocked;
+    //run queue (or parked list) links (job indices), only meaningful while pid != 0
+    int next;
+    int prev;
+}job;
+
+//which of a slot's heaps a slot_heap is
+#define HEAP_RUN 0
+#define HEAP_VRUNTIME 1
+
+// binary heap of a slot's jobs, job i sits at items[jobs[i].heap_pos[which]]
+typedef struct
+{
+    int *items;
+    int len;
+    int cap;
+    int which;
+}slot_heap;
+
+// one core the MCP schedules on
+typedef struct
+{
+    //CPU the slot's jobs are pinned to
+    int cpu;
+    //CLOCK_MONOTONIC timerfd, readable when this slot's slice is over
+    int timer_fd;
+    //run queue: one circular list through jobs[].next/prev per level
+    //runq[k] is the next job to run at level k, -1 if the level is empty
+    int runq[MLFQ_LEVELS];
+    //job holding this core right now, -1 if none
+    int running;
+    //jobs in the run queue (including the running one)
+    int length;
+    //CLOCK_MONOTONIC (ns) at which the running job's slice is over
+    long long slice_end_ns;
+    //last blocked-job probe: when, and the running job's CPU time then
+    long long last_probe_ns;
+    long long last_probe_cpu;
+    //ns spent idle (blocked job or no job), and since when if idle now
+    long long idle_ns;
+    long long idle_since;
+    //blocked jobs of this slot: one circular list through jobs[].next/prev
+    //(-1 if none), probed with the slot's timer until they wake
+    int parked;
+    int num_parked;
+    //CFS: the run queue's jobs in policy->before order (vruntime for cfs
+    //and stride), and on vruntime when that is not the same order (dag)
+    slot_heap heap;
+    slot_heap by_vruntime;
+    //CFS: never decreases, new and stolen jobs start from here
+    long long min_vruntime;
+    //LOTTERY: the slot's jobs in no particular order, and a Fenwick tree
+    //(1-based, lottery_cap entries) over their tickets for O(log n) draws
+    int *lottery;
+    long long *lottery_tree;
+    int lottery_len;
+    int lottery_cap;
+    long long lottery_total;
+    //trace: job (and its pid) that exited while running here, -1 if none
+    int exited;
+    pid_t exited_pid;
+    //simulation: virtual time (ns) the quantum timer fires at, 0 if disarmed
+    long long sim_timer_ns;
+}cpu_slot;
+
+// binary heap of job indices, before(a, b) says which comes out first
+typedef struct
+{
+    int *items;
+    int len;
+    int capacity;
+    int (*before)(int a, int b);
+}job_queue;
+
+// "key:value" options at the start of an input line
+typedef struct
+{
+    int weight;
+    //jobs (by index) that have to exit successfully before this one runs
+    int after[MAX_AFTER];
+    int num_after;
+    //at:<ms>, ns after MCP start
+    long long arrival_ns;
+    int tickets;
+}job_options;
+
+// one scheduling policy (-p <name>): the scheduler core (run queues, slots,
+// timers, signals, stealing) only calls these; policies[] lists them all,
+// so a new policy is its hooks plus one entry
+// a NULL hook has nothing to do, or does what its comment says
+typedef struct
+{
+    const char *name;
+    //dashboard title
+    const char *title;
+    //class every job is shown with, unless job_class says otherwise
+    const char *job_type;
+    //job i joined slot s's run queue (admitted, stolen, or moved a level)
+    void (*on_job_added)(int s, int i);
+    //job i is back on slot s from a sleep, just before it is added again
+    void (*on_job_woken)(int s, int i);
+    //job i left its slot's run queue (exited, stolen, or moved a level)
+    void (*on_job_removed)(int i);
+    //job slot s runs next, its queue is not empty
+    //(NULL: runq_pick, the head of the highest non-empty level)
+    int (*pick_next)(int s);
+    //slot s's running job used up its slice / gave the core back early
+    void (*on_quantum_expired)(int s);
+    void (*on_job_blocked)(int s);
+    //slice (us) job i gets when it is picked (NULL: one quantum), and its start
+    long (*next_quantum)(int i);
+    void (*on_slice_start)(int i);
+    //once per round of events, before any switch
+    void (*on_round)(void);
+    const char *(*job_class)(int i);
+    //does job a run before job b: heap order, and the dashboard's queue
+    //order (NULL: the order of the level lists)
+    int (*before)(int a, int b);
+}scheduling_policy;
+
+//nice -20..19 to weight, each step is ~10% of CPU (same table as Linux)
+static const int nice_to_weight[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+     9548,  7620,  6100,  4904,  3906,
+     3121,  2501,  1991,  1586,  1277,
+     1024,   820,   655,   526,   423,
+      335,   272,   215,   172,   137,
+      110,    87,    70,    56,    45,
+       36,    29,    23,    18,    15,
+};
 
 //global variables
-pid_t pids[64];
+//job table, grows by doubling
+job *jobs = NULL;
+int jobs_capacity = 0;
 int total_processes = 0;
-int current_process_index = -1; 
-int has_started[64] = {0}; 
-
-//NEW: arrays for each process
-//store time slice for each process
-int time_slices[64];
-//store "CPU" or "IO"
-char *proc_types[64];
-
-//helper function: read and print from /proc
-//satisfies monitoring requirement
-void update_and_print_process_info() {
-    //clear the screen 
-    //select what stats to display
-    printf("\033[H\033[J"); 
-    printf("MCP Smart Scheduler (Dynamic Time Slices)\n");
-    printf("--------------------------------------------------------------------------------------------\n");
-    printf("%-10s %-20s %-8s %-10s %-10s %-10s %-8s %-5s\n", 
-           "PID", "Name", "State", "UTime(s)", "STime(s)", "Mem(KB)", "Type", "Slice");
-    printf("--------------------------------------------------------------------------------------------\n");
-
-    //clock ticks per second
-    long clk_tck = sysconf(_SC_CLK_TCK);
-
-    //skip dead processes
-    for (int i = 0; i < total_processes; i++) {
-        if (pids[i] == 0) continue;
-        char path[256];
-        snprintf(path, sizeof(path), "/proc/%d/stat", pids[i]);
+//jobs admitted and not yet reaped
+int active_count = 0;
+
+//--max-active: at most this many jobs spawned at once, 0 for no limit
+//(the others wait parsed, as 'P' in the shared state; below -j it leaves
+//cores idle)
+int max_active = 0;
+//admission queue: the jobs ready to be admitted, longest critical path
+//on top (all equal without after: and --history: FIFO)
+job_queue admit_queue;
+long admit_count = 0;
+//live runs: jobs whose at:<ms> has not come yet, soonest on top
+//(a simulation leaves arrivals to sim.c)
+job_queue arrival_queue;
+//timerfd, readable when the top of arrival_queue is due
+int arrival_fd = -1;
+//a FIFO given with -f is read from the event loop as lines come in,
+//until its last writer closes it (-1: the whole file was read up front)
+int input_fd = -1;
+
+//--history: runtimes of earlier runs are read from and saved to this file
+char *history_path = NULL;
+//DAG: estimate (ns) of a job whose command has no history
+long long unknown_estimate_ns = 0;
+
+//one slot per core, set with -j <cores> (default 1)
+cpu_slot *slots = NULL;
+int num_slots = 1;
+
+//quantum length in microseconds, set with -q <ms> (default 1 second)
+long quantum_usec = 1000000;
+//shared memory segment the state is published in, set with -s <name>
+char shm_name[256];
+
+//how often a running job is checked for having blocked (a tenth of the
+//quantum), and parked jobs for having woken
+long probe_usec = 100000;
+
+//scheduling policy, set with -p <name> (default heuristic)
+const scheduling_policy *policy = NULL;
+//LOTTERY: xorshift state, fixed when simulating so a run can be repeated
+uint64_t lottery_seed = 1;
+//MLFQ: when (CLOCK_MONOTONIC, ns) all jobs were last moved back to level 0
+long long last_boost_ns = 0;
+
+//--simulate: jobs, clocks and /proc come from sim.c, time is virtual
+int simulating = 0;
+//shared state: published at most every PUBLISH_INTERVAL_MS (when it is
+//due, publish_stale says a round changed it since), and the first row
+//that may still change (the ones before it are exited jobs)
+long long next_publish_ns = 0;
+int publish_stale = 0;
+int publish_from = 0;
+//CLOCK_MONOTONIC (ns) at startup, trace timestamps count from here
+long long start_ns = 0;
+
+//event sources, all watched by epoll_fd
+int epoll_fd = -1;
+//SIGCHLD delivered as a readable fd instead of a handler
+int signal_fd = -1;
+//children tracked by PID only, reaped on SIGCHLD
+int legacy_count = 0;
+
+//arm slot s's quantum timer (one shot) for usec microseconds, 0 disarms it
+void set_quantum(int s, long usec) {
+    if (simulating) {
+        slots[s].sim_timer_ns = usec ? sim_now() + usec * 1000LL : 0;
+        return;
+    }
+    struct itimerspec its;
+    quantum_timerspec(usec, &its);
+    timerfd_settime(slots[s].timer_fd, 0, &its, NULL);
+}
+
+//CLOCK_MONOTONIC in nanoseconds
+long long now_ns() {
+    if (simulating) return sim_now();
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+//CPU time job i has used so far (ns), -1 if it cannot be read
+long long job_cpu_ns(int i) {
+    if (simulating) return sim_cpu_ns(i);
+    struct timespec ts;
+    if (!jobs[i].has_cpu_clock || clock_gettime(jobs[i].cpu_clock, &ts) != 0) return -1;
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+//what /proc/<pid>/stat says job i is doing ('R', 'S' ...), 0 if unknown
+char job_state(int i) {
+    if (simulating) return sim_state(i);
+    proc_stat st;
+    if (jobs[i].stat_fd < 0 || proc_stat_read(jobs[i].stat_fd, &st) != 0) return 0;
+    return st.state;
+}
+
+//activity counters of job i, returns 0 or -1 if they cannot be read
+int job_activity(int i, proc_activity *act) {
+    if (simulating) {
+        sim_activity(i, act);
+        return 0;
+    }
+    return proc_activity_read(&jobs[i].act_fds, act);
+}
+
+//start a usec long slice on slot s: arm its timer for the first probe
+void start_slice(int s, int i, long usec) {
+    cpu_slot *slot = &slots[s];
+    long long now = now_ns();
+    slot->slice_end_ns = now + usec * 1000LL;
+    slot->last_probe_ns = now;
+    slot->last_probe_cpu = job_cpu_ns(i);
+    set_quantum(s, usec < probe_usec ? usec : probe_usec);
+}
+
+//watch fd in epoll_fd, tagged with tag
+void watch_fd(int fd, uint64_t tag) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = tag;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        perror("epoll_ctl");
+        exit(1);
+    }
+}
+
+//add a job to the table, growing it when full
+//it has no process yet (job_attach gives it one), returns the new job's index
+int job_add() {
+    if (total_processes == jobs_capacity) {
+        int capacity = jobs_capacity ? jobs_capacity * 2 : 64;
+        job *grown = realloc(jobs, capacity * sizeof(job));
+        if (grown == NULL) {
+            perror("Job table");
+            exit(1);
+        }
+        jobs = grown;
+        jobs_capacity = capacity;
+    }
+
+    int i = total_processes++;
+    jobs[i].pid = 0;
+    jobs[i].pending = 1;
+    jobs[i].argv = NULL;
+    jobs[i].pidfd = -1;
+    jobs[i].stat_fd = -1;
+    jobs[i].act_fds.io_fd = jobs[i].act_fds.schedstat_fd = jobs[i].act_fds.status_fd = -1;
+    jobs[i].slice_sampled = 0;
+    jobs[i].slices_seen = 0;
+    jobs[i].ewma_syscall_rate = jobs[i].ewma_blocked = jobs[i].ewma_switch_rate = 0;
+    jobs[i].has_started = 0;
+    //default slice
+    jobs[i].time_slice = quantum_usec;
+    jobs[i].proc_type = "Init";
+    jobs[i].level = 0;
+    jobs[i].has_cpu_clock = 0;
+    jobs[i].slice_cpu_start = 0;
+    jobs[i].weight = NICE_0_WEIGHT;
+    jobs[i].tickets = DEFAULT_TICKETS;
+    jobs[i].lottery_pos = -1;
+    jobs[i].vruntime = 0;
+    jobs[i].heap_pos[HEAP_RUN] = jobs[i].heap_pos[HEAP_VRUNTIME] = -1;
+    jobs[i].cpu_ns = 0;
+    jobs[i].dependents = NULL;
+    jobs[i].num_dependents = jobs[i].deps_left = 0;
+    jobs[i].arrived = jobs[i].cancelled = 0;
+    jobs[i].estimate_ns = -1;
+    jobs[i].path_tail_ns = jobs[i].path_left_ns = 0;
+    jobs[i].command = NULL;
+    jobs[i].admit_seq = 0;
+    jobs[i].arrival_ns = 0;
+    jobs[i].first_run_ns = -1;
+    jobs[i].finish_ns = 0;
+    jobs[i].outcome = 0;
+    jobs[i].slot = 0;
+    jobs[i].blocked = 0;
+    jobs[i].next = jobs[i].prev = i;
+    return i;
+}
+
+//job i got its process: open what the policies read about it and watch
+//for its exit (simulating: pid is its sim.c index + 1, nothing to open)
+void job_attach(int i, pid_t pid, int pidfd) {
+    jobs[i].pid = pid;
+    jobs[i].pidfd = pidfd;
+    if (simulating) {
+        jobs[i].has_cpu_clock = 1;
+        return;
+    }
+    jobs[i].stat_fd = proc_stat_open(pid);
+    proc_activity_open(pid, &jobs[i].act_fds);
+    jobs[i].has_cpu_clock = clock_getcpuclockid(pid, &jobs[i].cpu_clock) == 0;
+    //if pidfds are unsupported (old kernel) SIGCHLD still reaps it
+    if (pidfd >= 0) {
+        watch_fd(pidfd, EV_TAG(EV_JOB, i));
+    } else {
+        legacy_count++;
+    }
+}
 
-        FILE *f = fopen(path, "r");
-        if (!f) {
-            // Process dead before checked
+void cancel_job(int i, int failed);
+
+//DAG: job i runs only once every job in opts->after exited successfully
+void job_after(int i, const job_options *opts) {
+    int failed = -1;
+    for (int k = 0; k < opts->num_after; k++) {
+        job *before = &jobs[opts->after[k]];
+        //read from a stream after that job was already gone
+        if (before->outcome == 1) continue;
+        if (before->outcome == -1) {
+            failed = opts->after[k];
             continue;
         }
+        //most jobs have few dependents: grow the list one at a time
+        int *grown = realloc(before->dependents, (before->num_dependents + 1) * sizeof(int));
+        if (grown == NULL) {
+            perror("Job table");
+            exit(1);
+        }
+        before->dependents = grown;
+        before->dependents[before->num_dependents++] = i;
+        jobs[i].deps_left++;
+    }
+    if (failed != -1) cancel_job(i, failed);
+}
+
+//pin job i to its slot's CPU (only with -j > 1, a single slot floats)
+void pin_job(int i) {
+    if (num_slots == 1 || simulating) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(slots[jobs[i].slot].cpu, &set);
+    sched_setaffinity(jobs[i].pid, sizeof(set), &set);
+}
+
+//CFS: does job a run before job b (ties go to the older job)
+//(STRIDE: the same on its pass)
+int cfs_before(int a, int b) {
+    if (jobs[a].vruntime != jobs[b].vruntime) return jobs[a].vruntime < jobs[b].vruntime;
+    return a < b;
+}
+
+//DAG: the longer remaining critical path first, then as CFS
+int dag_before(int a, int b) {
+    if (jobs[a].path_left_ns != jobs[b].path_left_ns) return jobs[a].path_left_ns > jobs[b].path_left_ns;
+    return cfs_before(a, b);
+}
+
+//LOTTERY: most tickets (most likely to win) first, then file order
+int lottery_before(int a, int b) {
+    if (jobs[a].tickets != jobs[b].tickets) return jobs[a].tickets > jobs[b].tickets;
+    return a < b;
+}
+
+//CFS: put job i at position pos of heap h
+void heap_set(slot_heap *h, int pos, int i) {
+    h->items[pos] = i;
+    jobs[i].heap_pos[h->which] = pos;
+}
+
+//CFS, DAG, STRIDE: each core's jobs are in a heap, in policy->before order
+//(DAG also keeps them on vruntime, for min_vruntime)
+int heap_before(const slot_heap *h, int a, int b) {
+    return h->which == HEAP_RUN ? policy->before(a, b) : cfs_before(a, b);
+}
+
+//does the policy order its heap on something else than vruntime
+int heap_needs_vruntime_order() {
+    return policy->before != cfs_before;
+}
+
+//CFS: restore the order of heap h around job i after its key changed
+void heap_fix(slot_heap *h, int i) {
+    int pos = jobs[i].heap_pos[h->which];
+
+    //sift up
+    while (pos > 0 && heap_before(h, i, h->items[(pos - 1) / 2])) {
+        heap_set(h, pos, h->items[(pos - 1) / 2]);
+        pos = (pos - 1) / 2;
+    }
+    //sift down
+    for (;;) {
+        int child = 2 * pos + 1;
+        if (child >= h->len) break;
+        if (child + 1 < h->len && heap_before(h, h->items[child + 1], h->items[child])) child++;
+        if (!heap_before(h, h->items[child], i)) break;
+        heap_set(h, pos, h->items[child]);
+        pos = child;
+    }
+    heap_set(h, pos, i);
+}
+
+//CFS: add job i to heap h
+void heap_add(slot_heap *h, int i) {
+    if (h->len == h->cap) {
+        int capacity = h->cap ? h->cap * 2 : 64;
+        int *grown = realloc(h->items, capacity * sizeof(int));
+        if (grown == NULL) {
+            perror("Run queue");
+            exit(1);
+        }
+        h->items = grown;
+        h->cap = capacity;
+    }
+    heap_set(h, h->len++, i);
+    heap_fix(h, i);
+}
+
+//CFS: take job i out of heap h
+void heap_delete(slot_heap *h, int i) {
+    int pos = jobs[i].heap_pos[h->which];
+    int last = h->items[--h->len];
+    jobs[i].heap_pos[h->which] = -1;
+    if (last != i) {
+        heap_set(h, pos, last);
+        heap_fix(h, last);
+    }
+}
+
+//CFS: add job i to slot s's heaps
+void heap_push(int s, int i) {
+    heap_add(&slots[s].heap, i);
+    if (heap_needs_vruntime_order()) heap_add(&slots[s].by_vruntime, i);
+}
+
+//CFS: take job i out of its slot's heaps
+void heap_remove(int i) {
+    cpu_slot *slot = &slots[jobs[i].slot];
+    heap_delete(&slot->heap, i);
+    if (heap_needs_vruntime_order()) heap_delete(&slot->by_vruntime, i);
+}
+
+//LOTTERY: add delta tickets at position pos of slot's tree
+void lottery_tree_add(cpu_slot *slot, int pos, long long delta) {
+    for (int k = pos + 1; k <= slot->lottery_cap; k += k & -k) {
+        slot->lottery_tree[k] += delta;
+    }
+}
+
+//LOTTERY: add job i to slot s's draw, O(log n) (O(n) when it grows)
+void lottery_add(int s, int i) {
+    cpu_slot *slot = &slots[s];
+    if (slot->lottery_len == slot->lottery_cap) {
+        int capacity = slot->lottery_cap ? slot->lottery_cap * 2 : 64;
+        int *grown = realloc(slot->lottery, capacity * sizeof(int));
+        long long *tree = calloc(capacity + 1, sizeof(long long));
+        if (grown == NULL || tree == NULL) {
+            perror("Run queue");
+            exit(1);
+        }
+        slot->lottery = grown;
+        free(slot->lottery_tree);
+        slot->lottery_tree = tree;
+        slot->lottery_cap = capacity;
+        //a bigger tree has other sums: rebuild it
+        for (int pos = 0; pos < slot->lottery_len; pos++) {
+            lottery_tree_add(slot, pos, jobs[slot->lottery[pos]].tickets);
+        }
+    }
+    int pos = slot->lottery_len++;
+    slot->lottery[pos] = i;
+    jobs[i].lottery_pos = pos;
+    lottery_tree_add(slot, pos, jobs[i].tickets);
+    slot->lottery_total += jobs[i].tickets;
+}
+
+//LOTTERY: take job i out of its slot's draw, the last job fills its place
+void lottery_remove(int i) {
+    cpu_slot *slot = &slots[jobs[i].slot];
+    int pos = jobs[i].lottery_pos;
+    int last_pos = --slot->lottery_len;
+    int last = slot->lottery[last_pos];
+    lottery_tree_add(slot, pos, -jobs[i].tickets);
+    slot->lottery_total -= jobs[i].tickets;
+    jobs[i].lottery_pos = -1;
+    if (last != i) {
+        lottery_tree_add(slot, last_pos, -jobs[last].tickets);
+        lottery_tree_add(slot, pos, jobs[last].tickets);
+        slot->lottery[pos] = last;
+        jobs[last].lottery_pos = pos;
+    }
+}
+
+//LOTTERY: next number of the xorshift64* generator
+uint64_t lottery_random() {
+    lottery_seed ^= lottery_seed >> 12;
+    lottery_seed ^= lottery_seed << 25;
+    lottery_seed ^= lottery_seed >> 27;
+    return lottery_seed * 2685821657736338717ULL;
+}
+
+//LOTTERY: draw a winning ticket among slot s's jobs (it must have some),
+//O(log n): walk down the tree to the job holding that ticket
+int lottery_draw(int s) {
+    cpu_slot *slot = &slots[s];
+    long long ticket = lottery_random() % slot->lottery_total;
+    int step = 1;
+    while (step * 2 <= slot->lottery_cap) step *= 2;
+    int pos = 0;
+    for (; step > 0; step /= 2) {
+        if (pos + step <= slot->lottery_cap && slot->lottery_tree[pos + step] <= ticket) {
+            pos += step;
+            ticket -= slot->lottery_tree[pos];
+        }
+    }
+    return slot->lottery[pos];
+}
+
+//link job i at the tail of its level in slot s's run queue (just before the head)
+void runq_insert(int s, int i) {
+    cpu_slot *slot = &slots[s];
+    int *head = &slot->runq[jobs[i].level];
+    jobs[i].slot = s;
+    slot->length++;
+    if (policy->on_job_added != NULL) policy->on_job_added(s, i);
+    if (*head == -1) {
+        *head = i;
+        jobs[i].next = jobs[i].prev = i;
+        return;
+    }
+    int tail = jobs[*head].prev;
+    jobs[i].prev = tail;
+    jobs[i].next = *head;
+    jobs[tail].next = i;
+    jobs[*head].prev = i;
+}
+
+//job i enters the system: it goes to the core with the shortest queue
+//(the lowest one on a tie, so jobs present from the start go round-robin)
+void job_arrived(int i) {
+    int s = 0;
+    for (int t = 1; t < num_slots; t++) {
+        if (slots[t].length < slots[s].length) s = t;
+    }
+    //CFS: start level with the jobs already there
+    jobs[i].vruntime = slots[s].min_vruntime;
+    runq_insert(s, i);
+    pin_job(i);
+    jobs[i].pending = 0;
+    active_count++;
+}
+
+//unlink job i from its slot, the job after it becomes the next pick
+void runq_remove(int i) {
+    cpu_slot *slot = &slots[jobs[i].slot];
+    int *head = &slot->runq[jobs[i].level];
+    int next = jobs[i].next;
+    int prev = jobs[i].prev;
+
+    if (policy->on_job_removed != NULL) policy->on_job_removed(i);
+    jobs[prev].next = next;
+    jobs[next].prev = prev;
+    if (*head == i) *head = next == i ? -1 : next;
+    if (slot->running == i) slot->running = -1;
+    slot->length--;
+}
+
+//take blocked job i off its slot's parked list
+void unpark_job(int i) {
+    cpu_slot *slot = &slots[jobs[i].slot];
+    int next = jobs[i].next;
+    int prev = jobs[i].prev;
+    jobs[prev].next = next;
+    jobs[next].prev = prev;
+    if (slot->parked == i) slot->parked = next == i ? -1 : next;
+    slot->num_parked--;
+    jobs[i].blocked = 0;
+}
+
+//job i's slice is over: the job after it in its level goes next
+void runq_rotate(int i) {
+    int *head = &slots[jobs[i].slot].runq[jobs[i].level];
+    if (*head == i) *head = jobs[i].next;
+}
+
+//move job i to the tail of another level, it keeps its core if running
+void set_level(int i, int level) {
+    int s = jobs[i].slot;
+    int was_running = slots[s].running == i;
+    runq_remove(i);
+    jobs[i].level = level;
+    jobs[i].time_slice = quantum_usec << level;
+    runq_insert(s, i);
+    if (was_running) slots[s].running = i;
+}
+
+//MLFQ: slice of slot s's running job is over, adjust its level
+void mlfq_quantum_expired(int s) {
+    int i = slots[s].running;
+    long long cpu = job_cpu_ns(i);
+    long long used = cpu - jobs[i].slice_cpu_start;
+    long long slice_ns = jobs[i].time_slice * 1000LL;
+
+    if (cpu < 0 || jobs[i].slice_cpu_start < 0) {
+        //no CPU clock: plain round robin at its current level
+        runq_rotate(i);
+    } else if (used * 2 >= slice_ns && jobs[i].level < MLFQ_LEVELS - 1) {
+        //used up its quantum: one level down, longer slices
+        set_level(i, jobs[i].level + 1);
+    } else if (used * 2 < slice_ns && jobs[i].level > 0) {
+        //gave the CPU back early (blocked): one level up
+        set_level(i, jobs[i].level - 1);
+    } else {
+        runq_rotate(i);
+    }
+}
 
-        // Variables to hold data
-        int pid;
-        char comm[256];
-        char state;
-        int ppid, pgrp, session, tty_nr, tpgid;
-        unsigned int flags;
-        unsigned long minflt, cminflt, majflt, cmajflt;
-        //user time, system time
-        unsigned long utime, stime; 
-        long cutime, cstime, priority, nice, num_threads, itrealvalue;
-        unsigned long long starttime;
-        //virtual memory size
-        unsigned long vsize; 
-
-        //scan file
-        fscanf(f, "%d %s %c %d %d %d %d %d %u %lu %lu %lu %lu %lu %lu %ld %ld %ld %ld %ld %ld %llu %lu",
-               &pid, comm, &state, &ppid, &pgrp, &session, &tty_nr, &tpgid, &flags,
-               &minflt, &cminflt, &majflt, &cmajflt, 
-               &utime, &stime, 
-               &cutime, &cstime, &priority, &nice, &num_threads, &itrealvalue, &starttime, 
-               &vsize);
-
-        fclose(f);
-
-        // Parse command name
-        //remove parenthesis
-        char *name_clean = comm;
-        if (comm[0] == '(') {
-            name_clean++;
-            size_t len = strlen(name_clean);
-            if (len > 0 && name_clean[len-1] == ')') {
-                name_clean[len-1] = '\0';
+//MLFQ: every job back to level 0, so nothing starves
+void mlfq_boost() {
+    for (int s = 0; s < num_slots; s++) {
+        for (int level = 1; level < MLFQ_LEVELS; level++) {
+            while (slots[s].runq[level] != -1) {
+                set_level(slots[s].runq[level], 0);
             }
         }
+    }
+    last_boost_ns = now_ns();
+}
+
+//MLFQ: periodic priority boost
+void mlfq_round() {
+    if (now_ns() - last_boost_ns >= MLFQ_BOOST_QUANTA * quantum_usec * 1000LL) mlfq_boost();
+}
 
-        //convert ticks to seconds
-        double u_cpu = (double)utime / clk_tck;
-        double s_cpu = (double)stime / clk_tck;
-        //convert bytes to kb
-        unsigned long mem_kb = vsize / 1024;
+//MLFQ: jobs are shown with their level
+const char *mlfq_class(int i) {
+    static const char *level_names[MLFQ_LEVELS] = { "Level 0", "Level 1", "Level 2", "Level 3" };
+    return level_names[jobs[i].level];
+}
+
+//heuristic: sample job i's counters as its slice starts
+void heuristic_slice_start(int i) {
+    jobs[i].slice_sampled = job_activity(i, &jobs[i].slice_act) == 0;
+    jobs[i].slice_wall_start = now_ns();
+}
 
-        //NEW: part 5
-        // Heuristic: 
+//heuristic: CPU or I/O, as the last slice showed
+const char *heuristic_class(int i) {
+    return jobs[i].proc_type;
+}
+
+//heuristic: fold one rate into its running average
+double ewma(double average, double sample) {
+    return HEUR_EWMA_ALPHA * sample + (1 - HEUR_EWMA_ALPHA) * average;
+}
+
+//heuristic: slice of slot s's running job is over, reclassify it
+void heuristic_quantum_expired(int s) {
+    int i = slots[s].running;
+    proc_activity now;
+    runq_rotate(i);
+    if (!jobs[i].slice_sampled || job_activity(i, &now) != 0) {
+        //no activity counters:
         //If user time > system time --> CPU Bound
         //If system time > user time --> I/O Bound
-        if (utime > stime) {
-            proc_types[i] = "CPU";
-            //more time for CPU bound
-            time_slices[i] = 2;
+        proc_stat st;
+        if (jobs[i].stat_fd >= 0 && proc_stat_read(jobs[i].stat_fd, &st) == 0) {
+            int cpu_bound = st.utime > st.stime;
+            jobs[i].proc_type = cpu_bound ? "CPU" : "I/O";
+            jobs[i].time_slice = cpu_bound ? 2 * quantum_usec : quantum_usec;
+        }
+        return;
+    }
+
+    proc_activity *then = &jobs[i].slice_act;
+    double wall_ms = (now_ns() - jobs[i].slice_wall_start) / 1e6;
+    double run_ms = (now.run_ns - then->run_ns) / 1e6;
+    double wait_ms = (now.wait_ns - then->wait_ns) / 1e6;
+    if (wall_ms <= 0) return;
+
+    //syscalls per ms on the CPU (none if it never ran)
+    double syscall_rate = run_ms > 0 ? (now.syscalls - then->syscalls) / run_ms : 0;
+    //what is left of the slice after running and waiting for a CPU
+    double blocked = 1 - (run_ms + wait_ms) / wall_ms;
+    if (blocked < 0) blocked = 0;
+    double switch_rate = (now.voluntary_switches - then->voluntary_switches) / wall_ms;
+
+    //the first slice seeds the averages
+    if (jobs[i].slices_seen++ == 0) {
+        jobs[i].ewma_syscall_rate = syscall_rate;
+        jobs[i].ewma_blocked = blocked;
+        jobs[i].ewma_switch_rate = switch_rate;
+    } else {
+        jobs[i].ewma_syscall_rate = ewma(jobs[i].ewma_syscall_rate, syscall_rate);
+        jobs[i].ewma_blocked = ewma(jobs[i].ewma_blocked, blocked);
+        jobs[i].ewma_switch_rate = ewma(jobs[i].ewma_switch_rate, switch_rate);
+    }
+
+    if (jobs[i].ewma_syscall_rate >= HEUR_IO_SYSCALLS_PER_MS ||
+        jobs[i].ewma_blocked >= HEUR_IO_BLOCKED ||
+        jobs[i].ewma_switch_rate >= HEUR_IO_SWITCHES_PER_MS) {
+        jobs[i].proc_type = "I/O";
+        //normal time for I/O bound
+        jobs[i].time_slice = quantum_usec;
+    } else {
+        jobs[i].proc_type = "CPU";
+        //more time for CPU bound
+        jobs[i].time_slice = 2 * quantum_usec;
+    }
+}
+
+//CPU time (ns) job i used in its slice, the whole slice without a CPU clock
+long long slice_used_ns(int i, long long cpu) {
+    if (cpu < 0 || jobs[i].slice_cpu_start < 0) return jobs[i].time_slice * 1000LL;
+    return cpu - jobs[i].slice_cpu_start;
+}
+
+//CFS, DAG, STRIDE: job i's key grew, move it back into heap order
+void heap_requeue(int s, int i) {
+    cpu_slot *slot = &slots[s];
+    heap_fix(&slot->heap, i);
+    //the lowest vruntime is the top of whichever heap is on vruntime
+    const slot_heap *h = &slot->heap;
+    if (heap_needs_vruntime_order()) {
+        heap_fix(&slot->by_vruntime, i);
+        h = &slot->by_vruntime;
+    }
+    long long top = jobs[h->items[0]].vruntime;
+    if (top > slot->min_vruntime) slot->min_vruntime = top;
+}
+
+//CFS: charge slot s's running job for the CPU time its slice used
+void cfs_quantum_expired(int s) {
+    int i = slots[s].running;
+    jobs[i].vruntime += slice_used_ns(i, job_cpu_ns(i)) * NICE_0_WEIGHT / jobs[i].weight;
+    heap_requeue(s, i);
+}
+
+//DAG: as CFS, and take what it used off its critical path
+void dag_quantum_expired(int s) {
+    int i = slots[s].running;
+    long long cpu = job_cpu_ns(i);
+    jobs[i].vruntime += slice_used_ns(i, cpu) * NICE_0_WEIGHT / jobs[i].weight;
+    //its own part of the critical path shrinks as it runs
+    long long left = jobs[i].estimate_ns - (cpu >= 0 ? cpu : jobs[i].cpu_ns);
+    jobs[i].path_left_ns = (left > 0 ? left : 0) + jobs[i].path_tail_ns;
+    heap_requeue(s, i);
+}
+
+//STRIDE: advance the pass of slot s's running job
+void stride_quantum_expired(int s) {
+    int i = slots[s].running;
+    //a whole stride per quantum used, part of one for a shorter slice
+    jobs[i].vruntime += (STRIDE1 / jobs[i].tickets) * slice_used_ns(i, job_cpu_ns(i)) / (quantum_usec * 1000LL);
+    heap_requeue(s, i);
+}
+
+//CFS, DAG: a job back from a sleep keeps at most a quantum of credit,
+//so a long sleeper cannot hold the core for as long as it slept
+void cfs_job_woken(int s, int i) {
+    long long floor = slots[s].min_vruntime - quantum_usec * 1000LL;
+    if (jobs[i].vruntime < floor) jobs[i].vruntime = floor;
+}
+
+//STRIDE: the same, at most one stride behind
+void stride_job_woken(int s, int i) {
+    long long floor = slots[s].min_vruntime - STRIDE1 / jobs[i].tickets;
+    if (jobs[i].vruntime < floor) jobs[i].vruntime = floor;
+}
+
+//RR: slice over or not, the job after it goes next
+void rr_quantum_expired(int s) {
+    runq_rotate(slots[s].running);
+}
+
+//RR, HEURISTIC, MLFQ: head of the highest non-empty level
+int runq_pick(int s) {
+    for (int level = 0; level < MLFQ_LEVELS; level++) {
+        if (slots[s].runq[level] != -1) return slots[s].runq[level];
+    }
+    return -1;
+}
+
+//CFS, DAG, STRIDE: top of the heap
+int heap_pick(int s) {
+    return slots[s].heap.items[0];
+}
+
+//LOTTERY: a new draw every time
+int lottery_pick(int s) {
+    return lottery_draw(s);
+}
+
+//the slice of job i starts: note its CPU clock, to see what it used
+void cpu_slice_start(int i) {
+    jobs[i].slice_cpu_start = job_cpu_ns(i);
+}
+
+//slice job i was given (the heuristic and MLFQ change it)
+long job_quantum(int i) {
+    return jobs[i].time_slice;
+}
+
+//RR, CFS, DAG, STRIDE, LOTTERY: always one quantum
+long fixed_quantum(int i) {
+    (void)i;
+    return quantum_usec;
+}
+
+//every policy -p knows, the first one is the default
+static const scheduling_policy policies[] = {
+    {
+        .name = "heuristic", .title = "MCP Smart Scheduler (Dynamic Time Slices)",
+        .pick_next = runq_pick,
+        .on_quantum_expired = heuristic_quantum_expired, .on_job_blocked = heuristic_quantum_expired,
+        .next_quantum = job_quantum, .on_slice_start = heuristic_slice_start,
+        .job_class = heuristic_class,
+    },
+    {
+        .name = "rr", .title = "MCP Scheduler (Round Robin)", .job_type = "RR",
+        .pick_next = runq_pick,
+        .on_quantum_expired = rr_quantum_expired, .on_job_blocked = rr_quantum_expired,
+        .next_quantum = fixed_quantum, .on_slice_start = cpu_slice_start,
+    },
+    {
+        .name = "mlfq", .title = "MCP Scheduler (Multi-Level Feedback Queue)",
+        .pick_next = runq_pick,
+        //a blocked job shows it on its CPU clock: it moves up
+        .on_quantum_expired = mlfq_quantum_expired, .on_job_blocked = mlfq_quantum_expired,
+        .next_quantum = job_quantum, .on_slice_start = cpu_slice_start,
+        .on_round = mlfq_round, .job_class = mlfq_class,
+    },
+    {
+        .name = "cfs", .title = "MCP Scheduler (Weighted Fair Share)", .job_type = "Fair",
+        .on_job_added = heap_push, .on_job_removed = heap_remove, .pick_next = heap_pick,
+        .on_job_woken = cfs_job_woken,
+        .on_quantum_expired = cfs_quantum_expired, .on_job_blocked = cfs_quantum_expired,
+        .next_quantum = fixed_quantum, .on_slice_start = cpu_slice_start,
+        .before = cfs_before,
+    },
+    {
+        .name = "dag", .title = "MCP Scheduler (Critical Path First)", .job_type = "Path",
+        .on_job_added = heap_push, .on_job_removed = heap_remove, .pick_next = heap_pick,
+        .on_job_woken = cfs_job_woken,
+        .on_quantum_expired = dag_quantum_expired, .on_job_blocked = dag_quantum_expired,
+        .next_quantum = fixed_quantum, .on_slice_start = cpu_slice_start,
+        .before = dag_before,
+    },
+    {
+        .name = "stride", .title = "MCP Scheduler (Stride)", .job_type = "Stride",
+        .on_job_added = heap_push, .on_job_removed = heap_remove, .pick_next = heap_pick,
+        .on_job_woken = stride_job_woken,
+        .on_quantum_expired = stride_quantum_expired, .on_job_blocked = stride_quantum_expired,
+        .next_quantum = fixed_quantum, .on_slice_start = cpu_slice_start,
+        .before = cfs_before,
+    },
+    {
+        //nothing to carry over from a slice, every pick is a new draw
+        .name = "lottery", .title = "MCP Scheduler (Lottery)", .job_type = "Lottery",
+        .on_job_added = lottery_add, .on_job_removed = lottery_remove, .pick_next = lottery_pick,
+        .next_quantum = fixed_quantum, .on_slice_start = cpu_slice_start,
+        .before = lottery_before,
+    },
+};
+#define NUM_POLICIES ((int)(sizeof(policies) / sizeof(policies[0])))
+
+//slot to steal from: the longest queue that has a job waiting, or -1
+int find_victim(int s) {
+    int victim = -1;
+    for (int v = 0; v < num_slots; v++) {
+        if (v == s || slots[v].length < 2) continue;
+        if (victim == -1 || slots[v].length > slots[victim].length) victim = v;
+    }
+    return victim;
+}
+
+//slot s ran dry: move over the job the victim would run last
+//(tail of its lowest non-empty level, never the job it is running)
+//returns 1 if a job was stolen
+int steal_job(int s) {
+    int victim = find_victim(s);
+    if (victim == -1) return 0;
+
+    cpu_slot *from = &slots[victim];
+    int i = -1;
+    for (int level = MLFQ_LEVELS - 1; level >= 0 && i == -1; level--) {
+        if (from->runq[level] == -1) continue;
+        int tail = jobs[from->runq[level]].prev;
+        if (tail == from->running) tail = jobs[tail].prev;
+        if (tail != from->running) i = tail;
+    }
+    runq_remove(i);
+    //CFS: keep its distance to the front of the queue it came from
+    jobs[i].vruntime += slots[s].min_vruntime - from->min_vruntime;
+    runq_insert(s, i);
+    pin_job(i);
+    return 1;
+}
+
+//fill in runq_pos of the jobs queued on slot s: the running job is 0, then
+//the first MCP_SHM_RUNQ_RANKED others in the order the slot would pick
+//them (the rest were left at MCP_SHM_RUNQ_RANKED)
+//a heap is only partly ordered and a lottery not at all: one walk keeps
+//the first few by policy->before in a short sorted array, O(n) per slot
+void publish_runq_positions(mcp_shm *state, int s) {
+    cpu_slot *slot = &slots[s];
+    int pos = 0;
+    if (slot->running != -1) state->jobs[slot->running].runq_pos = pos++;
+
+    int ranked[MCP_SHM_RUNQ_RANKED];
+    int len = 0;
+    for (int level = 0; level < MLFQ_LEVELS; level++) {
+        int head = slot->runq[level];
+        if (head == -1) continue;
+        int i = head;
+        do {
+            if (i != slot->running) {
+                if (policy->before == NULL) {
+                    //the level lists already are in pick order
+                    if (len == MCP_SHM_RUNQ_RANKED) break;
+                    ranked[len++] = i;
+                } else if (len < MCP_SHM_RUNQ_RANKED || policy->before(i, ranked[len - 1])) {
+                    int k = len < MCP_SHM_RUNQ_RANKED ? len++ : len - 1;
+                    while (k > 0 && policy->before(i, ranked[k - 1])) {
+                        ranked[k] = ranked[k - 1];
+                        k--;
+                    }
+                    ranked[k] = i;
+                }
+            }
+            i = jobs[i].next;
+        } while (i != head);
+    }
+    for (int k = 0; k < len; k++) {
+        state->jobs[ranked[k]].runq_pos = pos++;
+    }
+}
+
+//class the policy gave job i, as shown by the dashboard and the trace
+const char *job_class(int i) {
+    return policy->job_class != NULL ? policy->job_class(i) : policy->job_type;
+}
+
+//helper function: publish the job table in shared memory (mcp_shm.c)
+//satisfies monitoring requirement: the monitor thread, or anyone else,
+//reads it from there, /proc reading and printing happen in monitor.c
+void publish_state() {
+    mcp_shm *state = mcp_shm_begin(total_processes);
+
+    snprintf(state->title, sizeof(state->title), "%s", policy->title);
+
+    //rows below publish_from belong to exited jobs and were written already
+    for (int i = publish_from; i < total_processes; i++) {
+        mcp_shm_job *row = &state->jobs[i];
+        strncpy(row->type, job_class(i), sizeof(row->type));
+        row->pid = jobs[i].pid;
+        row->cpu = slots[jobs[i].slot].cpu;
+        row->slice_us = jobs[i].time_slice;
+        //stopped jobs do not use CPU: only running ones need a fresh read
+        if (jobs[i].pid != 0 && slots[jobs[i].slot].running == i) {
+            long long cpu = job_cpu_ns(i);
+            if (cpu >= 0) jobs[i].cpu_ns = cpu;
+        }
+        row->cpu_ns = jobs[i].cpu_ns;
+        if (jobs[i].pending) {
+            row->state = 'P';
+        } else if (jobs[i].pid == 0) {
+            row->state = 'X';
+        } else if (jobs[i].blocked) {
+            row->state = 'B';
         } else {
-            proc_types[i] = "I/O";
-            //normal time for I/O bound
-            time_slices[i] = 1;
+            row->state = slots[jobs[i].slot].running == i ? 'R' : 'W';
         }
+        row->runq_pos = row->state == 'W' || row->state == 'R' ? MCP_SHM_RUNQ_RANKED : -1;
+    }
+    while (publish_from < total_processes && state->jobs[publish_from].state == 'X') {
+        publish_from++;
+    }
+
+    state->num_cores = num_slots < MCP_SHM_MAX_CORES ? num_slots : MCP_SHM_MAX_CORES;
+    for (int s = 0; s < (int)state->num_cores; s++) {
+        state->cores[s].cpu = slots[s].cpu;
+        state->cores[s].idle_ns = slots[s].idle_ns;
+        state->cores[s].idle_since = slots[s].idle_since;
+    }
+    for (int s = 0; s < num_slots; s++) {
+        publish_runq_positions(state, s);
+    }
+    mcp_shm_end();
+}
 
-        printf("%-10d %-20s %-8c %-10.2f %-10.2f %-10lu %-8s %ds\n", 
-               pids[i], name_clean, state, u_cpu, s_cpu, mem_kb, proc_types[i], time_slices[i]);
+//live runs, after a round of events: publish now if the last publish is
+//PUBLISH_INTERVAL_MS old, else leave it to the event loop, which wakes up
+//for it in time
+void publish_state_soon() {
+    long long now = now_ns();
+    if (now < next_publish_ns) {
+        publish_stale = 1;
+        return;
     }
-    printf("--------------------------------------------------------------------------------------------\n");
+    publish_state();
+    publish_stale = 0;
+    next_publish_ns = now + PUBLISH_INTERVAL_MS * 1000000LL;
 }
 
-//schedule handler
-void schedule_handler(int signum) {
+//signal job i through its pidfd (kill() only without one)
+void send_signal(int i, int sig) {
+    if (simulating) {
+        sim_signal(i, sig);
+    } else if (jobs[i].pidfd >= 0) {
+        syscall(SYS_pidfd_send_signal, jobs[i].pidfd, sig, NULL, 0);
+    } else {
+        kill(jobs[i].pid, sig);
+    }
+}
+
+//add job i to q, O(log n)
+void queue_push(job_queue *q, int i) {
+    if (q->len == q->capacity) {
+        int capacity = q->capacity ? q->capacity * 2 : 64;
+        int *grown = realloc(q->items, capacity * sizeof(int));
+        if (grown == NULL) {
+            perror("Job queue");
+            exit(1);
+        }
+        q->items = grown;
+        q->capacity = capacity;
+    }
+    //sift up
+    int pos = q->len++;
+    while (pos > 0 && q->before(i, q->items[(pos - 1) / 2])) {
+        q->items[pos] = q->items[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+    q->items[pos] = i;
+}
+
+//take the top job off q (it must not be empty), O(log n)
+int queue_pop(job_queue *q) {
+    int top = q->items[0];
+    int last = q->items[--q->len];
+    //sift down
+    int pos = 0;
+    for (;;) {
+        int child = 2 * pos + 1;
+        if (child >= q->len) break;
+        if (child + 1 < q->len && q->before(q->items[child + 1], q->items[child])) child++;
+        if (!q->before(q->items[child], last)) break;
+        q->items[pos] = q->items[child];
+        pos = child;
+    }
+    if (q->len > 0) q->items[pos] = last;
+    return top;
+}
+
+//admission order: longer remaining critical path first, then first come
+int admit_before(int a, int b) {
+    if (jobs[a].path_left_ns != jobs[b].path_left_ns) return jobs[a].path_left_ns > jobs[b].path_left_ns;
+    return jobs[a].admit_seq < jobs[b].admit_seq;
+}
+
+//job i is ready: it waits in the admission queue
+void admit_push(int i) {
+    jobs[i].admit_seq = admit_count++;
+    queue_push(&admit_queue, i);
+}
+
+//job i is there: it is admitted once the jobs it is after are done
+void job_ready(int i) {
+    jobs[i].arrived = 1;
+    if (jobs[i].deps_left == 0 && !jobs[i].cancelled) admit_push(i);
+}
+
+//arrival order: soonest first, then file order
+int arrival_before(int a, int b) {
+    if (jobs[a].arrival_ns != jobs[b].arrival_ns) return jobs[a].arrival_ns < jobs[b].arrival_ns;
+    return a < b;
+}
+
+//arm arrival_fd for the top of arrival_queue, disarm it if there is none
+void arm_arrival_timer() {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    if (arrival_queue.len > 0) {
+        long long at = start_ns + jobs[arrival_queue.items[0]].arrival_ns;
+        its.it_value.tv_sec = at / 1000000000LL;
+        its.it_value.tv_nsec = at % 1000000000LL;
+    }
+    timerfd_settime(arrival_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+//arrival_fd fired: every job whose time has come is ready
+void arrivals_due() {
+    long long now = now_ns() - start_ns;
+    while (arrival_queue.len > 0 && jobs[arrival_queue.items[0]].arrival_ns <= now) {
+        job_ready(queue_pop(&arrival_queue));
+    }
+    arm_arrival_timer();
+}
+
+//live: job i has been read, it is ready at its at:<ms> (now if that passed)
+void job_read(int i) {
+    long long now = now_ns() - start_ns;
+    if (jobs[i].arrival_ns <= now) {
+        jobs[i].arrival_ns = now;
+        job_ready(i);
+        return;
+    }
+    queue_push(&arrival_queue, i);
+    if (arrival_queue.items[0] == i) arm_arrival_timer();
+}
+
+//DAG: job i is gone, the jobs after it have one job less to wait for
+//(none of them runs if it failed)
+void release_dependents(int i, int succeeded) {
+    for (int k = 0; k < jobs[i].num_dependents; k++) {
+        int d = jobs[i].dependents[k];
+        if (jobs[d].cancelled) continue;
+        if (!succeeded) {
+            cancel_job(d, i);
+        } else if (--jobs[d].deps_left == 0 && jobs[d].arrived) {
+            admit_push(d);
+        }
+    }
+}
+
+//DAG: job i will never run because failed (a job it is after) did not succeed
+void cancel_job(int i, int failed) {
+    jobs[i].cancelled = 1;
+    jobs[i].pending = 0;
+    jobs[i].outcome = -1;
+    fprintf(stderr, "Job %d not run: job %d failed\n", i, failed);
+    release_dependents(i, 0);
+}
+
+//job i has been reaped: forget it, O(1)
+//succeeded: it exited with status 0 (the jobs after it may run)
+void job_exited(int i, int succeeded) {
+    if (jobs[i].pid == 0) return;
+    if (jobs[i].pidfd >= 0) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, jobs[i].pidfd, NULL);
+        close(jobs[i].pidfd);
+        jobs[i].pidfd = -1;
+    } else if (!simulating) {
+        legacy_count--;
+    }
+    if (jobs[i].stat_fd >= 0) {
+        close(jobs[i].stat_fd);
+        jobs[i].stat_fd = -1;
+    }
+    proc_activity_close(&jobs[i].act_fds);
+    cpu_slot *slot = &slots[jobs[i].slot];
+    if (slot->running == i) {
+        slot->exited = i;
+        slot->exited_pid = jobs[i].pid;
+    }
+    if (jobs[i].blocked) {
+        unpark_job(i);
+    } else {
+        runq_remove(i);
+    }
+    jobs[i].pid = 0;
+    active_count--;
+    jobs[i].finish_ns = now_ns() - start_ns;
+    jobs[i].outcome = succeeded ? 1 : -1;
+    if (succeeded && jobs[i].command != NULL) history_update(jobs[i].command, jobs[i].cpu_ns);
+    release_dependents(i, succeeded);
+}
+
+//pidfd of job i is readable: reap exactly that child
+void reap_job(int i) {
+    siginfo_t info;
+    memset(&info, 0, sizeof(info));
+    if (jobs[i].pid == 0) return;
+    //a zombie's CPU clock still reads: its final CPU time, for --history
+    long long cpu = job_cpu_ns(i);
+    if (waitid(P_PIDFD, jobs[i].pidfd, &info, WEXITED | WNOHANG) == 0 && info.si_pid != 0) {
+        if (cpu >= 0) jobs[i].cpu_ns = cpu;
+        job_exited(i, info.si_code == CLD_EXITED && info.si_status == 0);
+    }
+}
+
+//SIGCHLD path: only children without a pidfd need looking at
+void reap_legacy_children() {
     int status;
-    pid_t finished_pid;
+    for (int i = 0; i < total_processes && legacy_count > 0; i++) {
+        if (jobs[i].pid != 0 && jobs[i].pidfd < 0 && waitpid(jobs[i].pid, &status, WNOHANG) == jobs[i].pid) {
+            job_exited(i, WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        }
+    }
+}
 
-    //reap zombies
-    while ((finished_pid = waitpid(-1, &status, WNOHANG)) > 0) {
-        for (int i = 0; i < total_processes; i++) {
-            if (pids[i] == finished_pid) {
-                pids[i] = 0;
-            }
+//trace one decision of slot s: stopped (or -1) gave the core to started
+//(or -1), the counters are those of stopped right now
+void trace_switch(int s, int reason, int stopped, int started) {
+    cpu_slot *slot = &slots[s];
+    trace_record rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.time_ns = now_ns() - start_ns;
+    rec.cpu = slot->cpu;
+    rec.reason = reason;
+    rec.stopped_job = stopped;
+    rec.started_job = started;
+    rec.cpu_ns = -1;
+
+    if (stopped != -1 && jobs[stopped].pid != 0) {
+        rec.stopped_pid = jobs[stopped].pid;
+        rec.cpu_ns = job_cpu_ns(stopped);
+        proc_activity act;
+        if (job_activity(stopped, &act) == 0) {
+            rec.has_activity = 1;
+            rec.syscalls = act.syscalls;
+            rec.io_chars = act.io_chars;
+            rec.run_ns = act.run_ns;
+            rec.wait_ns = act.wait_ns;
+            rec.voluntary_switches = act.voluntary_switches;
         }
+    } else if (stopped != -1) {
+        //reaped: nothing left to read
+        rec.stopped_pid = slot->exited_pid;
+    }
+    if (started != -1) {
+        rec.started_pid = jobs[started].pid;
+        rec.slice_us = jobs[started].time_slice;
+        strncpy(rec.type, job_class(started), sizeof(rec.type));
     }
+    trace_push(&rec);
+}
 
-    //check termination
-    int active_count = 0;
-    for (int i = 0; i < total_processes; i++) {
-        if (pids[i] != 0) active_count++;
+//slot s's running job sleeps in the kernel: stop it and take it off the
+//run queue so no policy picks it again (a job asleep in I/O keeps reading
+//'D' until the I/O ends, it cannot run beside the slot's next job after)
+void park_job(int s) {
+    cpu_slot *slot = &slots[s];
+    int i = slot->running;
+    send_signal(i, SIGSTOP);
+    long long cpu = job_cpu_ns(i);
+    //its CPU clock moving again means it woke
+    if (cpu >= 0) jobs[i].cpu_ns = cpu;
+    runq_remove(i);
+    jobs[i].blocked = 1;
+    slot->num_parked++;
+    if (slot->parked == -1) {
+        slot->parked = i;
+        jobs[i].next = jobs[i].prev = i;
+        return;
     }
+    int tail = jobs[slot->parked].prev;
+    jobs[i].prev = tail;
+    jobs[i].next = slot->parked;
+    jobs[tail].next = i;
+    jobs[slot->parked].prev = i;
+}
+
+//probe slot s's parked jobs: one that used CPU or no longer sleeps goes
+//back on the run queue, still stopped, to wait for its turn (schedule_next
+//continues it when it is picked)
+void probe_parked(int s) {
+    cpu_slot *slot = &slots[s];
+    for (int n = slot->num_parked; n > 0; n--) {
+        int i = slot->parked;
+        //rotate first: a woken job leaves, the others keep their order
+        slot->parked = jobs[i].next;
+        long long cpu = job_cpu_ns(i);
+        char state = job_state(i);
+        if (cpu == jobs[i].cpu_ns && (state == 'S' || state == 'D')) continue;
 
-    if (active_count == 0) {
-        exit(0);
+        unpark_job(i);
+        if (cpu >= 0) jobs[i].cpu_ns = cpu;
+        if (policy->on_job_woken != NULL) policy->on_job_woken(s, i);
+        runq_insert(s, i);
     }
+}
 
-    //update dashboard
-    //time slices
-    update_and_print_process_info();
+//scheduler: stop slot s's current job and give its core to the next one
+//reason is TRACE_EXPIRY or TRACE_BLOCK when its timer ended the slice
+//(a core with no running job works it out itself: exit or start)
+//runs from the event loop, never from a signal handler
+void schedule_next(int s, int reason) {
+    cpu_slot *slot = &slots[s];
+    //who is giving the core up, for the trace
+    int stopped = slot->running;
+    if (stopped == -1) {
+        stopped = slot->exited;
+        reason = stopped != -1 ? TRACE_EXIT : TRACE_START;
+    }
+    slot->exited = -1;
 
-    //stop current process
-    if (current_process_index != -1 && pids[current_process_index] != 0) {
-        kill(pids[current_process_index], SIGSTOP);
+    //the running job's slice is over: the policy steps past it (mlfq may move it)
+    if (slot->running != -1) {
+        if (reason == TRACE_BLOCK) {
+            if (policy->on_job_blocked != NULL) policy->on_job_blocked(s);
+            //asleep: nobody picks it until a probe sees it wake
+            park_job(s);
+        } else if (policy->on_quantum_expired != NULL) {
+            policy->on_quantum_expired(s);
+        }
     }
 
-    //find next process
-    do {
-        current_process_index = (current_process_index + 1) % total_processes;
-    } while (pids[current_process_index] == 0);
+    //empty queue: take work from a busier core, or go idle
+    if (slot->length == 0 && !steal_job(s)) {
+        slot->running = -1;
+        //keep probing parked jobs, they come back here
+        set_quantum(s, slot->num_parked > 0 ? probe_usec : 0);
+        if (slot->idle_since == 0) slot->idle_since = now_ns();
+        if (stopped != -1 && trace_enabled()) trace_switch(s, reason, stopped, -1);
+        return;
+    }
+    if (slot->idle_since != 0) {
+        slot->idle_ns += now_ns() - slot->idle_since;
+        slot->idle_since = 0;
+    }
+
+    //find next process: O(1) for the level lists, O(log n) for a heap or a draw
+    int next = policy->pick_next != NULL ? policy->pick_next(s) : runq_pick(s);
+
+    //stop current process (unless it simply keeps the CPU, or park_job did)
+    if (slot->running != -1 && slot->running != next && !jobs[slot->running].blocked) {
+        send_signal(slot->running, SIGSTOP);
+        //its CPU time will not change until it runs again
+        long long cpu = job_cpu_ns(slot->running);
+        if (cpu >= 0) jobs[slot->running].cpu_ns = cpu;
+    }
 
     //start/continue process
-    if (has_started[current_process_index] == 0) {
-        kill(pids[current_process_index], SIGUSR1);
-        has_started[current_process_index] = 1;
-    } else {
-        kill(pids[current_process_index], SIGCONT);
+    if (jobs[next].has_started == 0) {
+        send_signal(next, SIGUSR1);
+        jobs[next].has_started = 1;
+        jobs[next].first_run_ns = now_ns() - start_ns;
+    } else if (next != slot->running) {
+        send_signal(next, SIGCONT);
     }
+    slot->running = next;
+    if (policy->on_slice_start != NULL) policy->on_slice_start(next);
 
     //set alarm based on process type
-    int next_slice = time_slices[current_process_index];
+    long next_slice = policy->next_quantum != NULL ? policy->next_quantum(next) : quantum_usec;
     //default for safety
-    if (next_slice <= 0) next_slice = 1;
+    if (next_slice <= 0) next_slice = quantum_usec;
 
-    alarm(next_slice);
+    start_slice(s, next, next_slice);
+    if (trace_enabled()) trace_switch(s, reason, stopped, next);
 }
 
-int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        fprintf(stderr, "Invalid use: incorrect number of parameters\n");
+//slot s's timer fired: TRACE_EXPIRY if its slice is over, TRACE_BLOCK if
+//its job has blocked, 0 (timer re-armed for the next probe) if the job
+//keeps the core
+int slice_timer_fired(int s) {
+    cpu_slot *slot = &slots[s];
+    int i = slot->running;
+    //parked jobs that woke are queued again (an idle slot then picks)
+    if (slot->num_parked > 0) probe_parked(s);
+    if (i == -1) {
+        if (slot->num_parked > 0) set_quantum(s, probe_usec);
+        return 0;
+    }
+
+    long long now = now_ns();
+    if (now >= slot->slice_end_ns) return TRACE_EXPIRY;
+
+    //blocked: no CPU time since the last probe and asleep in the kernel
+    long long cpu = job_cpu_ns(i);
+    int progressed = cpu < 0 || cpu != slot->last_probe_cpu;
+    char state = progressed ? 0 : job_state(i);
+    if (state == 'S' || state == 'D') {
+        slot->idle_ns += now - slot->last_probe_ns;
+        return TRACE_BLOCK;
+    }
+    slot->last_probe_ns = now;
+    slot->last_probe_cpu = cpu;
+
+    //never 0, that would disarm the timer
+    long remaining = (slot->slice_end_ns - now) / 1000 + 1;
+    set_quantum(s, remaining < probe_usec ? remaining : probe_usec);
+    return 0;
+}
+
+//slot s needs a pick: its own job left, or it is idle and work exists
+int slot_needs_job(int s) {
+    if (slots[s].running != -1) return 0;
+    return slots[s].length > 0 || find_victim(s) != -1;
+}
+
+//fork job i's process: it waits in sigwait() for its first SIGUSR1
+void spawn_job(int i) {
+    char **args = jobs[i].argv;
+    pid_t pid = fork();
+
+    if (pid < 0) { perror("Fork Failed"); exit(1); }
+    else if (pid == 0) {
+        sigset_t sigset;
+        sigemptyset(&sigset);
+        sigaddset(&sigset, SIGUSR1);
+        sigprocmask(SIG_BLOCK, &sigset, NULL);
+        int caught_sig;
+        sigwait(&sigset, &caught_sig);
+
+        //the job starts with nothing blocked (not even our SIGCHLD)
+        sigemptyset(&sigset);
+        sigprocmask(SIG_SETMASK, &sigset, NULL);
+
+        execvp(args[0], args);
+        perror("Execvp");
+        //the MCP's threads may hold stdio locks: no exit handlers here
+        _exit(1);
+    }
+
+    //pidfd: readable the instant the child exits
+    job_attach(i, pid, syscall(SYS_pidfd_open, pid, 0));
+    //the child has its copy: the descriptor is all that is left of the line
+    for (int a = 0; args[a] != NULL; a++) {
+        free(args[a]);
+    }
+    free(args);
+    jobs[i].argv = NULL;
+}
+
+//admit ready jobs, longest critical path first, while fewer than max_active are running
+//(simulating: sim.c starts its script, else its process is forked)
+void admit_jobs() {
+    while (admit_queue.len > 0 && (max_active == 0 || active_count < max_active)) {
+        int i = queue_pop(&admit_queue);
+        if (simulating) {
+            sim_start(i);
+            job_attach(i, i + 1, -1);
+        } else {
+            spawn_job(i);
+        }
+        job_arrived(i);
+    }
+}
+
+//parse one token of an input line into opts
+//returns 1 for an option, 0 if the command starts here, -1 if malformed
+int parse_job_option(const char *token, job_options *opts) {
+    char *end;
+    if (strncmp(token, "weight:", 7) == 0) {
+        long weight = strtol(token + 7, &end, 10);
+        if (end == token + 7 || *end != '\0' || weight < 1 || weight > 1000000) return -1;
+        opts->weight = weight;
+        return 1;
+    }
+    if (strncmp(token, "nice:", 5) == 0) {
+        long nice = strtol(token + 5, &end, 10);
+        if (end == token + 5 || *end != '\0' || nice < -20 || nice > 19) return -1;
+        opts->weight = nice_to_weight[nice + 20];
+        return 1;
+    }
+    if (strncmp(token, "tickets:", 8) == 0) {
+        long tickets = strtol(token + 8, &end, 10);
+        if (end == token + 8 || *end != '\0' || tickets < 1 || tickets > 1000000) return -1;
+        opts->tickets = tickets;
+        return 1;
+    }
+    if (strncmp(token, "at:", 3) == 0) {
+        double ms = strtod(token + 3, &end);
+        if (end == token + 3 || *end != '\0' || ms < 0) return -1;
+        opts->arrival_ns = (long long)(ms * 1e6);
+        return 1;
+    }
+    if (strncmp(token, "after:", 6) == 0) {
+        //comma separated indices of earlier jobs, so there can be no cycle
+        const char *id = token + 6;
+        do {
+            long before = strtol(id, &end, 10);
+            if (end == id || before < 0 || before >= total_processes || opts->num_after == MAX_AFTER) return -1;
+            opts->after[opts->num_after++] = before;
+            id = end + 1;
+        } while (*end == ',');
+        return *end == '\0' ? 1 : -1;
+    }
+    return 0;
+}
+
+//args joined by single spaces, in a new string
+char *join_args(char **args) {
+    size_t size = 1;
+    for (int a = 0; args[a] != NULL; a++) {
+        size += strlen(args[a]) + 1;
+    }
+    char *joined = malloc(size);
+    if (joined == NULL) {
+        perror("Job table");
         exit(1);
     }
-    
-    FILE *file = fopen(argv[2], "r");
-    if (!file) { perror("Error opening file"); exit(1); }
+    joined[0] = '\0';
+    for (int a = 0; args[a] != NULL; a++) {
+        if (a > 0) strcat(joined, " ");
+        strcat(joined, args[a]);
+    }
+    return joined;
+}
 
-    // Initialize arrays
-    for(int k=0; k<64; k++) {
-        //default slice
-        time_slices[k] = 1;
-        proc_types[k] = "Init";
+//DAG: estimate every job's CPU time (--history, else the mean of the
+//known ones, else a quantum), then its critical path: itself plus the
+//longest chain of jobs after it
+void plan_critical_paths() {
+    long long known = 0;
+    int num_known = 0;
+    for (int i = 0; i < total_processes; i++) {
+        if (jobs[i].estimate_ns < 0) continue;
+        known += jobs[i].estimate_ns;
+        num_known++;
     }
+    unknown_estimate_ns = num_known > 0 ? known / num_known : quantum_usec * 1000LL;
 
-    signal(SIGALRM, schedule_handler);
+    //a job is only after earlier ones: walking backwards, the jobs after
+    //job i are all done when it is reached
+    for (int i = total_processes - 1; i >= 0; i--) {
+        if (jobs[i].estimate_ns < 0) jobs[i].estimate_ns = unknown_estimate_ns;
+        for (int k = 0; k < jobs[i].num_dependents; k++) {
+            long long tail = jobs[jobs[i].dependents[k]].path_left_ns;
+            if (tail > jobs[i].path_tail_ns) jobs[i].path_tail_ns = tail;
+        }
+        jobs[i].path_left_ns = jobs[i].estimate_ns + jobs[i].path_tail_ns;
+    }
+}
+
+//add the job on one input line (options, then its command or script)
+//returns its index, -1 if the line is empty, a comment or malformed
+int add_job_line(char *line) {
+    size_t len = strlen(line);
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+        line[--len] = '\0';
+    }
+
+    char *args[64];
+    int i = 0;
+    char *token = strtok(line, " \t\n");
+    while (token != NULL && i < 63) {
+        args[i++] = token;
+        token = strtok(NULL, " \t\n");
+    }
+    args[i] = NULL;
+
+    //leading "key:value" tokens are options, the command follows them
+    job_options opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.weight = NICE_0_WEIGHT;
+    opts.tickets = DEFAULT_TICKETS;
+    int first = 0;
+    int option;
+    while (args[first] != NULL && (option = parse_job_option(args[first], &opts)) == 1) {
+        first++;
+    }
+    if (args[first] != NULL && option == -1) {
+        fprintf(stderr, "Invalid job option: '%s', job skipped\n", args[first]);
+        return -1;
+    }
+
+    if (args[first] == NULL) return -1;
+
+    if (simulating) {
+        //the rest of the line is the job's script, it arrives later
+        if (args[first][0] == '#') return -1;
+        //sim.c and jobs[] number the jobs the same way
+        if (sim_add(&args[first], opts.arrival_ns) == -1) return -1;
+    }
+
+    int j = job_add();
+    jobs[j].weight = opts.weight;
+    jobs[j].tickets = opts.tickets;
+    jobs[j].arrival_ns = opts.arrival_ns;
+    job_after(j, &opts);
+    if (history_path != NULL) {
+        jobs[j].command = join_args(&args[first]);
+        jobs[j].estimate_ns = history_lookup(jobs[j].command);
+    }
+    if (simulating) return j;
 
-    char *line = NULL;
-    size_t len = 0;
-    ssize_t nread;
+    //keep the command, it is forked when the job is admitted
+    int count = i - first;
+    jobs[j].argv = malloc((count + 1) * sizeof(char *));
+    if (jobs[j].argv == NULL) { perror("Job table"); exit(1); }
+    for (int a = 0; a < count; a++) {
+        jobs[j].argv[a] = strdup(args[first + a]);
+        if (jobs[j].argv[a] == NULL) { perror("Job table"); exit(1); }
+    }
+    jobs[j].argv[count] = NULL;
+    return j;
+}
+
+//a line came in on the input stream: that job has arrived (or will at its at:)
+void stream_line(char *line) {
+    int j = add_job_line(line);
+    if (j == -1) return;
+    //its own estimate only: jobs read before it do not see a longer path
+    if (jobs[j].estimate_ns < 0) jobs[j].estimate_ns = unknown_estimate_ns;
+    jobs[j].path_left_ns = jobs[j].estimate_ns;
+    job_read(j);
+}
 
-    while ((nread = getline(&line, &len, file)) != -1) {
-        while (nread > 0 && (line[nread - 1] == '\n' || line[nread - 1] == '\r')) {
-            line[nread - 1] = '\0'; nread--;
+//input_fd is readable: add every complete line, and the last one at the
+//end of the stream (when its last writer closed it)
+void read_input() {
+    static char *buffer = NULL;
+    static size_t used = 0;
+    static size_t capacity = 0;
+    int eof = 0;
+
+    for (;;) {
+        if (capacity - used < 4096) {
+            capacity = capacity ? capacity * 2 : 8192;
+            buffer = realloc(buffer, capacity);
+            if (buffer == NULL) {
+                perror("Input");
+                exit(1);
+            }
         }
-        
-        char *args[64];
-        int i = 0;
-        char *token = strtok(line, " \t\n");
-        while (token != NULL && i < 63) {
-            args[i++] = token;
-            token = strtok(NULL, " \t\n");
+        //one byte kept for the '\0'
+        ssize_t n = read(input_fd, buffer + used, capacity - used - 1);
+        if (n > 0) {
+            used += n;
+            continue;
         }
-        args[i] = NULL;
+        if (n == -1 && errno == EINTR) continue;
+        eof = n == 0 || errno != EAGAIN;
+        break;
+    }
+
+    char *line = buffer;
+    char *newline;
+    while ((newline = memchr(line, '\n', used - (line - buffer))) != NULL) {
+        *newline = '\0';
+        stream_line(line);
+        line = newline + 1;
+    }
+    used -= line - buffer;
+    memmove(buffer, line, used);
+    if (!eof) return;
+
+    if (used > 0) {
+        buffer[used] = '\0';
+        stream_line(buffer);
+    }
+    free(buffer);
+    buffer = NULL;
+    used = capacity = 0;
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, input_fd, NULL);
+    close(input_fd);
+    input_fd = -1;
+}
 
-        if (args[0] == NULL) continue;
+//after a round of events: MLFQ boost, then a switch on every slot whose
+//quantum_over is set (the reason) or whose core is free
+void run_schedulers(char *quantum_over) {
+    //MLFQ: periodic priority boost
+    if (policy->on_round != NULL) policy->on_round();
 
-        pid_t pid = fork();
+    //switch on quantum expiry, or right away if a running job exited
+    //(even the last one, so the trace sees it go)
+    for (int s = 0; s < num_slots; s++) {
+        if (!quantum_over[s] && !slot_needs_job(s) && slots[s].exited == -1) continue;
+        int reason = quantum_over[s];
+        quantum_over[s] = 0;
+        schedule_next(s, reason);
+    }
+}
 
-        if (pid < 0) { perror("Fork Failed"); exit(1); }
-        else if (pid == 0) {
-            sigset_t sigset;
-            sigemptyset(&sigset);
-            sigaddset(&sigset, SIGUSR1);
-            sigprocmask(SIG_BLOCK, &sigset, NULL);
-            int caught_sig;
-            sigwait(&sigset, &caught_sig); 
-            
-            execvp(args[0], args); 
-            perror("Execvp");
+//wait for events until every job has exited, and no more can come
+void event_loop() {
+    struct epoll_event events[64];
+    char *quantum_over = calloc(num_slots, 1);
+    if (quantum_over == NULL) {
+        perror("Event loop");
+        exit(1);
+    }
+
+    while (active_count > 0 || admit_queue.len > 0 || arrival_queue.len > 0 || input_fd >= 0) {
+        //a round since the last publish: wake up for the next one
+        int timeout = -1;
+        if (publish_stale) {
+            long long wait_ns = next_publish_ns - now_ns();
+            timeout = wait_ns > 0 ? (int)((wait_ns + 999999) / 1000000) : 0;
+        }
+        int n = epoll_wait(epoll_fd, events, 64, timeout);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
             exit(1);
         }
-        else {
-            pids[total_processes++] = pid;
+        if (n == 0) {
+            publish_state_soon();
+            continue;
+        }
+
+        for (int e = 0; e < n; e++) {
+            uint64_t tag = events[e].data.u64;
+            int index = EV_INDEX(tag);
+
+            if (EV_TYPE(tag) == EV_TIMER) {
+                //clear the expiration count
+                unsigned long long expirations;
+                read(slots[index].timer_fd, &expirations, sizeof(expirations));
+                //slice over, or the job blocked early (else: next probe)
+                int reason = slice_timer_fired(index);
+                if (reason) quantum_over[index] = reason;
+            } else if (EV_TYPE(tag) == EV_ARRIVAL) {
+                unsigned long long expirations;
+                read(arrival_fd, &expirations, sizeof(expirations));
+                arrivals_due();
+            } else if (EV_TYPE(tag) == EV_INPUT) {
+                read_input();
+            } else if (EV_TYPE(tag) == EV_SIGNAL) {
+                //drain queued SIGCHLDs, then reap whoever exited
+                struct signalfd_siginfo info;
+                while (read(signal_fd, &info, sizeof(info)) == sizeof(info));
+                reap_legacy_children();
+            } else {
+                //pidfd readable: that child has exited
+                reap_job(index);
+            }
+        }
+
+        //exits made room: let waiting jobs in before the cores pick
+        admit_jobs();
+        run_schedulers(quantum_over);
+        //the monitor thread draws it whenever it next wakes up
+        publish_state_soon();
+    }
+    free(quantum_over);
+}
+
+//simulation: run the policies against sim.c's jobs in virtual time,
+//jumping from one event (burst over, arrival, quantum timer) to the next
+void simulate() {
+    char *quantum_over = calloc(num_slots, 1);
+    if (quantum_over == NULL) {
+        perror("Simulation");
+        exit(1);
+    }
+
+    while (active_count > 0 || sim_pending() > 0 || admit_queue.len > 0) {
+        long long t = sim_next_event();
+        for (int s = 0; s < num_slots; s++) {
+            long long timer = slots[s].sim_timer_ns;
+            if (timer != 0 && (t == -1 || timer < t)) t = timer;
+        }
+        if (t == -1) break;
+        sim_advance(t);
+
+        int i;
+        int event;
+        while ((event = sim_poll(&i)) != 0) {
+            if (event == SIM_ARRIVED) {
+                job_ready(i);
+            } else {
+                //a script always runs to its end
+                jobs[i].cpu_ns = job_cpu_ns(i);
+                job_exited(i, 1);
+            }
+        }
+        for (int s = 0; s < num_slots; s++) {
+            if (slots[s].sim_timer_ns == 0 || slots[s].sim_timer_ns > t) continue;
+            slots[s].sim_timer_ns = 0;
+            int reason = slice_timer_fired(s);
+            if (reason) quantum_over[s] = reason;
         }
+        admit_jobs();
+        run_schedulers(quantum_over);
     }
+    free(quantum_over);
+}
 
-    free(line);
-    fclose(file);
+//live runs: response and turnaround per job, counted from its arrival
+//(a simulation has sim_report for this)
+void report() {
+    printf("%-6s %-12s %-12s %-12s %-12s\n", "Job", "Arrival(ms)", "CPU(ms)", "Response(ms)", "Turnaround(ms)");
+    printf("%s\n", SEPARATOR);
 
-    //start
-    schedule_handler(SIGALRM);
+    double total_response = 0, total_turnaround = 0;
+    int finished = 0;
+    for (int i = 0; i < total_processes; i++) {
+        //never ran (a job it was after failed)
+        if (jobs[i].outcome == 0 || jobs[i].first_run_ns < 0) continue;
+        double response = (jobs[i].first_run_ns - jobs[i].arrival_ns) / 1e6;
+        double turnaround = (jobs[i].finish_ns - jobs[i].arrival_ns) / 1e6;
+        printf("%-6d %-12.2f %-12.2f %-12.2f %-12.2f%s\n", i, jobs[i].arrival_ns / 1e6, jobs[i].cpu_ns / 1e6,
+               response, turnaround, jobs[i].outcome == 1 ? "" : "  (failed)");
+        total_response += response;
+        total_turnaround += turnaround;
+        finished++;
+    }
+    printf("%s\n", SEPARATOR);
+    if (finished > 0) {
+        printf("%-6s %-12s %-12s %-12.2f %-12.2f\n", "Mean", "", "",
+               total_response / finished, total_turnaround / finished);
+    }
+    printf("Jobs: %d finished of %d, all done at %.2f ms\n", finished, total_processes, (now_ns() - start_ns) / 1e6);
+}
+
+//live runs only: signals, fd limit, epoll and signalfd
+void setup_events() {
+    //SIGCHLD is read from signal_fd: block it before any child exists
+    //SIGUSR1 too, so each child is born with it blocked and cannot be
+    //killed by its start signal before it reaches sigwait()
+    //SA_NOCLDSTOP: no wakeups for our own SIGSTOP/SIGCONT
+    sigset_t chld_set;
+    sigemptyset(&chld_set);
+    sigaddset(&chld_set, SIGCHLD);
+    sigset_t block_set = chld_set;
+    sigaddset(&block_set, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &block_set, NULL);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SIG_DFL;
+    sa.sa_flags = SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &sa, NULL);
+
+    //a pidfd and four /proc fds per job: allow as many open fds as the hard limit does
+    struct rlimit lim;
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur < lim.rlim_max) {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &lim);
+    }
+
+    //event sources
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    signal_fd = signalfd(-1, &chld_set, SFD_CLOEXEC | SFD_NONBLOCK);
+    if (epoll_fd == -1 || signal_fd == -1) {
+        perror("Event setup failed");
+        exit(1);
+    }
+    watch_fd(signal_fd, EV_TAG(EV_SIGNAL, 0));
+
+    //at:<ms> arrivals, armed for the soonest one
+    arrival_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (arrival_fd == -1) {
+        perror("Event setup failed");
+        exit(1);
+    }
+    watch_fd(arrival_fd, EV_TAG(EV_ARRIVAL, 0));
+}
+
+int main(int argc, char *argv[]) {
+    //parse "-f <file> [-q <ms>] [-j <cores>] [-p heuristic|rr|mlfq|cfs|dag|stride|lottery] [-s <shm name>]
+    //[--trace <file>] [--max-active <n>] [--history <file>]", or "--simulate <workload>" instead of -f
+    static const struct option long_options[] = {
+        { "trace", required_argument, NULL, 't' },
+        { "simulate", required_argument, NULL, 'S' },
+        { "max-active", required_argument, NULL, 'm' },
+        { "history", required_argument, NULL, 'H' },
+        { NULL, 0, NULL, 0 }
+    };
+    char *input_path = NULL;
+    char *trace_path = NULL;
+    admit_queue.before = admit_before;
+    arrival_queue.before = arrival_before;
+    policy = &policies[0];
+    int opt;
+    int bad_option = 0;
+    //report bad options ourselves
+    opterr = 0;
+    while (!bad_option && (opt = getopt_long(argc, argv, "f:q:j:p:s:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'f':
+                input_path = optarg;
+                break;
+            case 'q':
+                quantum_usec = quantum_from_ms(optarg);
+                //probe for blocked jobs ten times a quantum, at most every ms
+                probe_usec = quantum_usec / 10 < 1000 ? 1000 : quantum_usec / 10;
+                break;
+            case 'j':
+                //number of jobs running at once, one per core
+                num_slots = atoi(optarg);
+                if (num_slots < 1) {
+                    fprintf(stderr, "Invalid core count: '%s' (at least 1)\n", optarg);
+                    exit(1);
+                }
+                break;
+            case 'p':
+                policy = NULL;
+                for (int k = 0; k < NUM_POLICIES; k++) {
+                    if (strcmp(optarg, policies[k].name) == 0) policy = &policies[k];
+                }
+                if (policy == NULL) {
+                    fprintf(stderr, "Invalid policy: '%s' (", optarg);
+                    for (int k = 0; k < NUM_POLICIES; k++) {
+                        fprintf(stderr, "%s%s", k ? ", " : "", policies[k].name);
+                    }
+                    fprintf(stderr, ")\n");
+                    exit(1);
+                }
+                break;
+            case 't':
+                trace_path = optarg;
+                break;
+            case 'H':
+                history_path = optarg;
+                break;
+            case 'm':
+                //jobs spawned at once, the rest wait in the admission queue
+                max_active = atoi(optarg);
+                if (max_active < 1) {
+                    fprintf(stderr, "Invalid active job limit: '%s' (at least 1)\n", optarg);
+                    exit(1);
+                }
+                break;
+            case 'S':
+                input_path = optarg;
+                simulating = 1;
+                break;
+            case 's':
+                //POSIX shm names start with a single '/'
+                snprintf(shm_name, sizeof(shm_name), "%s%s", optarg[0] == '/' ? "" : "/", optarg);
+                break;
+            default:
+                bad_option = 1;
+                break;
+        }
+    }
+    if (bad_option || input_path == NULL || optind != argc) {
+        fprintf(stderr, "Invalid use: incorrect number of parameters\n");
+        exit(1);
+    }
+
+    //a FIFO blocks here until its first writer opens it
+    int fd = open(input_path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) { perror("Error opening file"); exit(1); }
+    struct stat input_stat;
+    int streaming = !simulating && fstat(fd, &input_stat) == 0 && S_ISFIFO(input_stat.st_mode);
+
+    //trace timestamps start here (0 when simulating)
+    start_ns = now_ns();
+    //a live run draws differently every time
+    if (!simulating) lottery_seed = start_ns ^ ((uint64_t)getpid() << 32);
+
+    //shared state, /dev/shm/mcp-<pid> unless -s names it
+    if (shm_name[0] == '\0') {
+        snprintf(shm_name, sizeof(shm_name), "/mcp-%d", getpid());
+    }
+    if (trace_path != NULL && trace_open(trace_path, simulating) != 0) {
+        perror(trace_path);
+        exit(1);
+    }
+    if (history_path != NULL && history_load(history_path) != 0) {
+        perror(history_path);
+        exit(1);
+    }
+    if (!simulating && mcp_shm_create(shm_name) != 0) {
+        //EEXIST: another MCP publishes under that -s name
+        perror(shm_name);
+        exit(1);
+    }
+
+    if (!simulating) setup_events();
+
+    //slots take the CPUs we may run on in order, wrapping if -j asks for more
+    cpu_set_t allowed;
+    int num_cpus = 0;
+    int cpu_ids[CPU_SETSIZE];
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &allowed)) cpu_ids[num_cpus++] = c;
+        }
+    }
+    if (num_cpus == 0) cpu_ids[num_cpus++] = 0;
+
+    slots = calloc(num_slots, sizeof(cpu_slot));
+    if (slots == NULL) { perror("Slots"); exit(1); }
+    for (int s = 0; s < num_slots; s++) {
+        //a simulation has as many (virtual) CPUs as it likes
+        slots[s].cpu = simulating ? s : cpu_ids[s % num_cpus];
+        for (int level = 0; level < MLFQ_LEVELS; level++) {
+            slots[s].runq[level] = -1;
+        }
+        slots[s].running = -1;
+        slots[s].exited = -1;
+        slots[s].parked = -1;
+        slots[s].heap.which = HEAP_RUN;
+        slots[s].by_vruntime.which = HEAP_VRUNTIME;
+        slots[s].timer_fd = -1;
+        if (simulating) continue;
+        slots[s].timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+        if (slots[s].timer_fd == -1) {
+            perror("Event setup failed");
+            exit(1);
+        }
+        watch_fd(slots[s].timer_fd, EV_TAG(EV_TIMER, s));
+    }
+
+    if (streaming) {
+        //lines are read by the event loop as they come
+        input_fd = fd;
+        fcntl(input_fd, F_SETFL, O_NONBLOCK);
+        watch_fd(input_fd, EV_TAG(EV_INPUT, 0));
+    } else {
+        FILE *file = fdopen(fd, "r");
+        if (!file) { perror("Error opening file"); exit(1); }
+        char *line = NULL;
+        size_t len = 0;
+        while (getline(&line, &len, file) != -1) {
+            add_job_line(line);
+        }
+        free(line);
+        fclose(file);
+    }
+
+    //jobs are ready as their at:<ms> comes (critical path first)
+    plan_critical_paths();
+    for (int j = 0; j < total_processes && !simulating; j++) {
+        job_read(j);
+    }
+
+    //start every core, and the dashboard
+    last_boost_ns = now_ns();
+    if (simulating) {
+        //jobs arriving start the cores
+        simulate();
+        trace_close();
+        printf("Simulated %s scheduler: %d core(s), %ld ms quantum\n",
+               policy->name, num_slots, quantum_usec / 1000);
+        sim_report();
+    } else {
+        //the first max_active jobs (all of them without a limit)
+        admit_jobs();
+        for (int s = 0; s < num_slots && active_count > 0; s++) {
+            schedule_next(s, 0);
+        }
+        publish_state();
+        monitor_start(shm_name);
+        event_loop();
+        publish_state();
+        monitor_stop();
+        mcp_shm_destroy();
+        trace_close();
+        report();
+        close(arrival_fd);
+        close(signal_fd);
+        close(epoll_fd);
+    }
+
+    for (int s = 0; s < num_slots; s++) {
+        if (slots[s].timer_fd >= 0) close(slots[s].timer_fd);
+        free(slots[s].heap.items);
+        free(slots[s].by_vruntime.items);
+        free(slots[s].lottery);
+        free(slots[s].lottery_tree);
+    }
+    //what every successful job used, for the next run's estimates
+    if (history_path != NULL) {
+        if (history_save(history_path) != 0) perror(history_path);
+        history_free();
+    }
 
-    while (1) {
-        pause();
+    free(slots);
+    for (int j = 0; j < total_processes; j++) {
+        free(jobs[j].dependents);
+        free(jobs[j].command);
     }
+    free(jobs);
+    free(admit_queue.items);
+    free(arrival_queue.items);
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,128 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "proc_stat.h"
+
+//open /proc/<pid>/<name>
+static int open_proc_file(pid_t pid, const char *name) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/%s", pid, name);
+    return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+int proc_stat_open(pid_t pid) {
+    return open_proc_file(pid, "stat");
+}
+
+//parse an unsigned decimal at *p, leave *p on the character after it
+static unsigned long parse_ulong(const char **p, const char *end) {
+    unsigned long value = 0;
+    while (*p < end && **p >= '0' && **p <= '9') {
+        value = value * 10 + (**p - '0');
+        (*p)++;
+    }
+    return value;
+}
+
+//step *p past count space-separated fields
+static void skip_fields(const char **p, const char *end, int count) {
+    while (count > 0 && *p < end) {
+        if (**p == ' ') count--;
+        (*p)++;
+    }
+}
+
+int proc_stat_read(int fd, proc_stat *st) {
+    //a stat line is well under 1 KiB
+    char buf[1024];
+    ssize_t n = pread(fd, buf, sizeof(buf), 0);
+    if (n <= 0) return -1;
+    const char *end = buf + n;
+
+    //comm: everything between the first '(' and the last ')'
+    const char *open_paren = memchr(buf, '(', n);
+    const char *close_paren = memrchr(buf, ')', n);
+    if (open_paren == NULL || close_paren == NULL || close_paren < open_paren) return -1;
+    size_t len = close_paren - open_paren - 1;
+    if (len >= sizeof(st->comm)) len = sizeof(st->comm) - 1;
+    memcpy(st->comm, open_paren + 1, len);
+    st->comm[len] = '\0';
+
+    //") S ppid ..." : field 3 is the state
+    const char *p = close_paren + 2;
+    if (p >= end) return -1;
+    st->state = *p;
+
+    //field 3 -> 14
+    skip_fields(&p, end, 11);
+    st->utime = parse_ulong(&p, end);
+    //15
+    skip_fields(&p, end, 1);
+    st->stime = parse_ulong(&p, end);
+    //15 -> 23
+    skip_fields(&p, end, 8);
+    if (p >= end) return -1;
+    st->vsize = parse_ulong(&p, end);
+    return 0;
+}
+
+
+void proc_activity_open(pid_t pid, proc_activity_fds *fds) {
+    fds->io_fd = open_proc_file(pid, "io");
+    fds->schedstat_fd = open_proc_file(pid, "schedstat");
+    fds->status_fd = open_proc_file(pid, "status");
+}
+
+void proc_activity_close(proc_activity_fds *fds) {
+    if (fds->io_fd >= 0) close(fds->io_fd);
+    if (fds->schedstat_fd >= 0) close(fds->schedstat_fd);
+    if (fds->status_fd >= 0) close(fds->status_fd);
+    fds->io_fd = fds->schedstat_fd = fds->status_fd = -1;
+}
+
+//pread a whole (small) proc file into buf as a string, returns its length or -1
+static ssize_t read_proc_file(int fd, char *buf, size_t size) {
+    if (fd < 0) return -1;
+    ssize_t n = pread(fd, buf, size - 1, 0);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+    return n;
+}
+
+//value of a "key: number" line, -1 (as unsigned) if the key is missing
+static unsigned long long key_value(const char *buf, const char *key) {
+    const char *p = strstr(buf, key);
+    if (p == NULL) return (unsigned long long)-1;
+    p += strlen(key);
+    while (*p == ' ' || *p == '\t') p++;
+    return strtoull(p, NULL, 10);
+}
+
+int proc_activity_read(const proc_activity_fds *fds, proc_activity *act) {
+    //status is the biggest of the three, about 1.5 KiB
+    char buf[4096];
+
+    if (read_proc_file(fds->io_fd, buf, sizeof(buf)) < 0) return -1;
+    unsigned long long syscr = key_value(buf, "syscr:");
+    unsigned long long syscw = key_value(buf, "syscw:");
+    unsigned long long rchar = key_value(buf, "rchar:");
+    unsigned long long wchar = key_value(buf, "wchar:");
+    if (syscr == (unsigned long long)-1 || syscw == (unsigned long long)-1) return -1;
+    act->syscalls = syscr + syscw;
+    act->io_chars = rchar + wchar;
+
+    //schedstat: "<run ns> <wait ns> <timeslices>"
+    if (read_proc_file(fds->schedstat_fd, buf, sizeof(buf)) < 0) return -1;
+    char *end;
+    act->run_ns = strtoull(buf, &end, 10);
+    act->wait_ns = strtoull(end, NULL, 10);
+
+    if (read_proc_file(fds->status_fd, buf, sizeof(buf)) < 0) return -1;
+    //"\nvoluntary_" so nonvoluntary_ctxt_switches does not match
+    act->voluntary_switches = key_value(buf, "\nvoluntary_ctxt_switches:");
+    if (act->voluntary_switches == (unsigned long long)-1) return -1;
+    return 0;
+}
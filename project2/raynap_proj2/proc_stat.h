@@ -0,0 +1,74 @@
+/*
+
+Persistent /proc/<pid>/stat sampler for the MCP monitors
+    - the stat file is opened once per job and re-read with pread(),
+      no fopen/fscanf/fclose per job per tick
+    - the line is parsed by hand: comm runs from the first '(' to the
+      LAST ')', so names with spaces or ')' in them parse correctly,
+      and only the fields the monitors show are converted
+    - proc_activity reads the counters that say what a job is doing
+      (/proc/<pid>/io, schedstat and status) the same way: fds kept
+      open, pread(), only the wanted keys parsed
+
+*/
+
+#ifndef PROC_STAT_H_
+#define PROC_STAT_H_
+
+#include <sys/types.h>
+
+// the fields of /proc/<pid>/stat the MCP uses
+typedef struct
+{
+    //field 2, without the parentheses (truncated to fit)
+    char comm[64];
+    //field 3: R, S, D, T, Z ...
+    char state;
+    //fields 14 and 15, clock ticks
+    unsigned long utime;
+    unsigned long stime;
+    //field 23, bytes
+    unsigned long vsize;
+}proc_stat;
+
+// cumulative activity counters of one process
+typedef struct
+{
+    //io: read/write style syscalls (syscr + syscw)
+    unsigned long long syscalls;
+    //io: bytes passed through them (rchar + wchar)
+    unsigned long long io_chars;
+    //schedstat: ns spent on a CPU, ns spent runnable but waiting for one
+    unsigned long long run_ns;
+    unsigned long long wait_ns;
+    //status: times the process blocked and gave up the CPU
+    unsigned long long voluntary_switches;
+}proc_activity;
+
+// the files proc_activity_read re-reads, -1 where one could not be opened
+typedef struct
+{
+    int io_fd;
+    int schedstat_fd;
+    int status_fd;
+}proc_activity_fds;
+
+//open /proc/<pid>/stat for proc_stat_read, returns an fd or -1
+int proc_stat_open(pid_t pid);
+
+//re-read and parse an fd from proc_stat_open
+//returns 0 on success, -1 if the process is gone or the line is malformed
+int proc_stat_read(int fd, proc_stat *st);
+
+//open the activity files of pid into fds
+void proc_activity_open(pid_t pid, proc_activity_fds *fds);
+
+//close the fds from proc_activity_open
+void proc_activity_close(proc_activity_fds *fds);
+
+//re-read every activity counter of fds
+//returns 0 on success, -1 if any file is missing or unreadable
+int proc_activity_read(const proc_activity_fds *fds, proc_activity *act);
+
+
+#endif /* PROC_STAT_H_ */
@@ -0,0 +1,298 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include "sim.h"
+
+#define SEPARATOR "---------------------------------------------------------------------------"
+
+//job lifecycle
+#define SIM_PENDING 0
+#define SIM_QUEUED 1
+#define SIM_READY 2
+#define SIM_DONE 3
+
+// one step of a job's script
+typedef struct
+{
+    //1: an I/O wait, 0: CPU work
+    int io;
+    long long ns;
+}sim_burst;
+
+// one simulated job
+typedef struct
+{
+    long long arrival_ns;
+    sim_burst *bursts;
+    int num_bursts;
+    //current burst and how much of it is left (ns)
+    int burst;
+    long long left;
+    //SIM_PENDING, SIM_QUEUED (arrived, not admitted), SIM_READY or SIM_DONE
+    int state;
+    //1 while the MCP lets it run
+    int running;
+    //counters, as /proc would show them
+    long long cpu_ns;
+    long long wait_ns;
+    unsigned long long syscalls;
+    unsigned long long switches;
+    //first time the MCP ran it (-1: not yet), and when it finished
+    long long first_run_ns;
+    long long finish_ns;
+}sim_job;
+
+// arrival or exit waiting for sim_poll
+typedef struct
+{
+    int type;
+    int job;
+}sim_event;
+
+static sim_job *sim_jobs = NULL;
+static int num_jobs = 0;
+static int jobs_capacity = 0;
+static int pending = 0;
+static long long now = 0;
+
+//events of the last sim_advance, read from events[polled] on
+static sim_event *events = NULL;
+static int num_events = 0;
+static int events_capacity = 0;
+static int polled = 0;
+
+//grow *array to hold count elements of size bytes
+static void ensure_capacity(void **array, int *capacity, int count, size_t size) {
+    if (count <= *capacity) return;
+    int grown_capacity = *capacity ? *capacity : 64;
+    while (grown_capacity < count) grown_capacity *= 2;
+    void *grown = realloc(*array, grown_capacity * size);
+    if (grown == NULL) {
+        perror("Simulation");
+        exit(1);
+    }
+    *array = grown;
+    *capacity = grown_capacity;
+}
+
+static void queue_event(int type, int job) {
+    ensure_capacity((void **)&events, &events_capacity, num_events + 1, sizeof(sim_event));
+    events[num_events].type = type;
+    events[num_events].job = job;
+    num_events++;
+}
+
+//parse "<prefix><ms>" into ns, -1 if token is not one (or not positive)
+static long long parse_ms(const char *token, const char *prefix) {
+    size_t len = strlen(prefix);
+    if (strncmp(token, prefix, len) != 0) return -1;
+    char *end;
+    double ms = strtod(token + len, &end);
+    if (end == token + len || *end != '\0' || ms < 0) return -1;
+    return (long long)(ms * 1e6);
+}
+
+//job j starts burst b (or is done at now)
+static void enter_burst(int j, int b) {
+    sim_job *job = &sim_jobs[j];
+    job->burst = b;
+    if (b == job->num_bursts) {
+        job->state = SIM_DONE;
+        job->finish_ns = now;
+        queue_event(SIM_EXITED, j);
+        return;
+    }
+    job->left = job->bursts[b].ns;
+    if (job->bursts[b].io) {
+        //one blocking syscall, and the CPU given up for it
+        job->syscalls++;
+        job->switches++;
+    }
+}
+
+int sim_add(char **tokens, long long arrival_ns) {
+    long long arrival = arrival_ns;
+    sim_burst *bursts = NULL;
+    int count = 0;
+    int capacity = 0;
+    int repeat = 1;
+
+    for (int t = 0; tokens[t] != NULL && tokens[t][0] != '#'; t++) {
+        long long ns;
+        char *end;
+        if ((ns = parse_ms(tokens[t], "at:")) >= 0) {
+            arrival = ns;
+        } else if ((ns = parse_ms(tokens[t], "cpu:")) > 0 || (ns = parse_ms(tokens[t], "io:")) > 0) {
+            ensure_capacity((void **)&bursts, &capacity, count + 1, sizeof(sim_burst));
+            bursts[count].io = tokens[t][0] == 'i';
+            bursts[count].ns = ns;
+            count++;
+        } else if (tokens[t][0] == 'x' && (tokens[t + 1] == NULL || tokens[t + 1][0] == '#') &&
+                   (repeat = strtol(tokens[t] + 1, &end, 10)) > 0 && *end == '\0') {
+            //repeat count, last token only
+        } else {
+            fprintf(stderr, "Invalid workload token: '%s', job skipped\n", tokens[t]);
+            free(bursts);
+            return -1;
+        }
+    }
+    if (count == 0) {
+        fprintf(stderr, "Invalid workload line: no cpu: or io: burst, job skipped\n");
+        free(bursts);
+        return -1;
+    }
+    if (repeat > 1) {
+        ensure_capacity((void **)&bursts, &capacity, count * repeat, sizeof(sim_burst));
+        for (int k = 1; k < repeat; k++) {
+            memcpy(&bursts[k * count], bursts, count * sizeof(sim_burst));
+        }
+        count *= repeat;
+    }
+
+    ensure_capacity((void **)&sim_jobs, &jobs_capacity, num_jobs + 1, sizeof(sim_job));
+    int j = num_jobs++;
+    sim_job *job = &sim_jobs[j];
+    memset(job, 0, sizeof(*job));
+    job->arrival_ns = arrival;
+    job->bursts = bursts;
+    job->num_bursts = count;
+    job->state = SIM_PENDING;
+    job->first_run_ns = -1;
+    pending++;
+    return j;
+}
+
+long long sim_now(void) {
+    return now;
+}
+
+int sim_pending(void) {
+    return pending;
+}
+
+long long sim_next_event(void) {
+    long long next = -1;
+    for (int j = 0; j < num_jobs; j++) {
+        sim_job *job = &sim_jobs[j];
+        long long t = -1;
+        if (job->state == SIM_PENDING) {
+            t = job->arrival_ns;
+        } else if (job->state == SIM_READY && (job->bursts[job->burst].io || job->running)) {
+            //I/O runs out on its own, CPU work only on a core
+            t = now + job->left;
+        }
+        if (t >= 0 && (next == -1 || t < next)) next = t;
+    }
+    return next;
+}
+
+void sim_advance(long long t) {
+    long long dt = t - now;
+    now = t;
+    num_events = 0;
+    polled = 0;
+
+    for (int j = 0; j < num_jobs; j++) {
+        sim_job *job = &sim_jobs[j];
+        if (job->state == SIM_PENDING) {
+            if (job->arrival_ns > now) continue;
+            job->state = SIM_QUEUED;
+            pending--;
+            queue_event(SIM_ARRIVED, j);
+            continue;
+        }
+        if (job->state == SIM_QUEUED) {
+            //not admitted yet: waiting like any runnable job
+            job->wait_ns += dt;
+            continue;
+        }
+        if (job->state != SIM_READY) continue;
+
+        if (job->bursts[job->burst].io) {
+            job->left -= dt;
+        } else if (job->running) {
+            job->left -= dt;
+            job->cpu_ns += dt;
+        } else {
+            //runnable, but the MCP has not given it a core
+            job->wait_ns += dt;
+        }
+        if (job->left <= 0) enter_burst(j, job->burst + 1);
+    }
+}
+
+void sim_start(int job) {
+    sim_jobs[job].state = SIM_READY;
+    enter_burst(job, 0);
+}
+
+int sim_poll(int *job) {
+    if (polled == num_events) return 0;
+    *job = events[polled].job;
+    return events[polled++].type;
+}
+
+void sim_signal(int job, int sig) {
+    sim_job *sj = &sim_jobs[job];
+    if (sig == SIGSTOP) {
+        sj->running = 0;
+    } else if (sig == SIGCONT || sig == SIGUSR1) {
+        sj->running = 1;
+        if (sj->first_run_ns < 0) sj->first_run_ns = now;
+    }
+}
+
+long long sim_cpu_ns(int job) {
+    return sim_jobs[job].cpu_ns;
+}
+
+char sim_state(int job) {
+    sim_job *sj = &sim_jobs[job];
+    if (sj->state == SIM_DONE) return 'Z';
+    return sj->state == SIM_READY && sj->bursts[sj->burst].io ? 'S' : 'R';
+}
+
+void sim_activity(int job, proc_activity *act) {
+    sim_job *sj = &sim_jobs[job];
+    act->syscalls = sj->syscalls;
+    act->io_chars = 0;
+    act->run_ns = sj->cpu_ns;
+    act->wait_ns = sj->wait_ns;
+    act->voluntary_switches = sj->switches;
+}
+
+void sim_report(void) {
+    printf("%-6s %-12s %-12s %-12s %-12s %-12s\n",
+           "Job", "Arrival(ms)", "CPU(ms)", "Response(ms)", "Wait(ms)", "Turnaround(ms)");
+    printf("%s\n", SEPARATOR);
+
+    double total_response = 0, total_wait = 0, total_turnaround = 0;
+    int finished = 0;
+    for (int j = 0; j < num_jobs; j++) {
+        sim_job *job = &sim_jobs[j];
+        if (job->state != SIM_DONE) continue;
+        double response = (job->first_run_ns - job->arrival_ns) / 1e6;
+        double wait = job->wait_ns / 1e6;
+        double turnaround = (job->finish_ns - job->arrival_ns) / 1e6;
+        printf("%-6d %-12.2f %-12.2f %-12.2f %-12.2f %-12.2f\n",
+               j, job->arrival_ns / 1e6, job->cpu_ns / 1e6, response, wait, turnaround);
+        total_response += response;
+        total_wait += wait;
+        total_turnaround += turnaround;
+        finished++;
+    }
+    printf("%s\n", SEPARATOR);
+    if (finished > 0) {
+        printf("%-6s %-12s %-12s %-12.2f %-12.2f %-12.2f\n", "Mean", "", "",
+               total_response / finished, total_wait / finished, total_turnaround / finished);
+    }
+    printf("Jobs: %d finished of %d, all done at %.2f ms\n", finished, num_jobs, now / 1e6);
+
+    for (int j = 0; j < num_jobs; j++) {
+        free(sim_jobs[j].bursts);
+    }
+    free(sim_jobs);
+    free(events);
+}
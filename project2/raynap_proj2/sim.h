@@ -0,0 +1,74 @@
+/*
+
+Simulated jobs for the MCP's offline mode (part5 --simulate <workload>)
+    - stands in for the kernel: jobs are scripts of CPU bursts and I/O
+      waits, time is virtual (ns from 0) and only moves when the MCP
+      asks, so a run takes as long as the scheduling decisions do
+    - the MCP keeps making its own decisions with its own policy code;
+      only what it reads (clock, CPU clocks, /proc state and counters)
+      and the signals it sends are answered from here
+    - a job progresses through a CPU burst only while the MCP lets it run
+      (SIGUSR1/SIGCONT until SIGSTOP) on one of its cores; an I/O wait
+      goes on whether it is stopped or not, like a sleep in the kernel
+    - an arrived job does nothing until the MCP admits it (sim_start),
+      the time it spends waiting for that counts as wait time
+    - no context switch cost is charged
+
+workload file: one job per line, '#' starts a comment
+    [MCP job options, at:<ms>] cpu:<ms> io:<ms> cpu:<ms> ... [x<n>]
+    - at: arrival time (default 0), x<n> repeats the bursts n times
+    - e.g. "cpu:3000" is CPU bound, "at:500 cpu:2 io:20 x100" arrives
+      half a second in and mostly waits on I/O
+
+*/
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include "proc_stat.h"
+
+//what sim_poll reports
+#define SIM_ARRIVED 1
+#define SIM_EXITED 2
+
+//add a job from the tokens after its MCP options (NULL terminated),
+//arriving at arrival_ns (the at: option, an at: token among them wins)
+//returns its index (jobs are numbered in order from 0), -1 if malformed
+int sim_add(char **tokens, long long arrival_ns);
+
+//virtual time (ns)
+long long sim_now(void);
+
+//jobs that have not arrived yet
+int sim_pending(void);
+
+//when the next burst ends or job arrives, -1 if nothing will happen
+long long sim_next_event(void);
+
+//the MCP admits job i (after SIM_ARRIVED): its first burst starts now
+void sim_start(int job);
+
+//move time forward to t, running every job the MCP lets run
+void sim_advance(long long t);
+
+//next arrival or exit since the last sim_advance: returns SIM_ARRIVED or
+//SIM_EXITED and sets *job, 0 when there is none left
+int sim_poll(int *job);
+
+//the MCP signals job i (SIGUSR1, SIGCONT or SIGSTOP)
+void sim_signal(int job, int sig);
+
+//CPU time job i has used (ns)
+long long sim_cpu_ns(int job);
+
+//what /proc/<pid>/stat would say: 'R', 'S' (waiting on I/O) or 'Z'
+char sim_state(int job);
+
+//the /proc counters of job i
+void sim_activity(int job, proc_activity *act);
+
+//per job and mean response, wait and turnaround times (ms)
+void sim_report(void);
+
+
+#endif /* SIM_H_ */
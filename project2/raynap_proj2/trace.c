@@ -0,0 +1,208 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "trace.h"
+
+static const char *reason_names[] = { "", "start", "expiry", "block", "exit" };
+
+//the ring: the MCP only moves head, the flusher only moves tail
+static trace_record *ring = NULL;
+static uint64_t head = 0;
+static uint64_t tail = 0;
+//records lost to a full ring (MCP side only)
+static uint64_t dropped = 0;
+static int lossless = 0;
+
+static FILE *out = NULL;
+static int as_json = 0;
+
+//wakes the flusher early: it has to stop, or a lossless MCP is waiting
+//for room (then room_cond wakes the MCP once the flusher drained)
+static pthread_mutex_t flush_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t flush_cond;
+static pthread_cond_t room_cond = PTHREAD_COND_INITIALIZER;
+static int stopping = 0;
+static int waiting_for_room = 0;
+static pthread_t flush_thread;
+
+//1 if path ends in suffix
+static int ends_with(const char *path, const char *suffix) {
+    size_t len = strlen(path);
+    size_t suffix_len = strlen(suffix);
+    return len >= suffix_len && strcmp(path + len - suffix_len, suffix) == 0;
+}
+
+//write one record as a CSV row or a JSON object
+static void write_record(const trace_record *rec) {
+    char type[TRACE_TYPE_LEN + 1];
+    memcpy(type, rec->type, TRACE_TYPE_LEN);
+    type[TRACE_TYPE_LEN] = '\0';
+    const char *reason = reason_names[rec->reason];
+
+    if (as_json) {
+        fprintf(out, "{\"time_ns\":%lld,\"cpu\":%d,\"reason\":\"%s\",",
+                (long long)rec->time_ns, (int)rec->cpu, reason);
+        if (rec->stopped_job >= 0) {
+            fprintf(out, "\"stopped_job\":%d,\"stopped_pid\":%d,", (int)rec->stopped_job, (int)rec->stopped_pid);
+        } else {
+            fprintf(out, "\"stopped_job\":null,\"stopped_pid\":null,");
+        }
+        if (rec->started_job >= 0) {
+            fprintf(out, "\"started_job\":%d,\"started_pid\":%d,\"slice_us\":%lld,\"type\":\"%s\",",
+                    (int)rec->started_job, (int)rec->started_pid, (long long)rec->slice_us, type);
+        } else {
+            fprintf(out, "\"started_job\":null,\"started_pid\":null,\"slice_us\":null,\"type\":null,");
+        }
+        if (rec->cpu_ns >= 0) {
+            fprintf(out, "\"cpu_ns\":%lld,", (long long)rec->cpu_ns);
+        } else {
+            fprintf(out, "\"cpu_ns\":null,");
+        }
+        if (rec->has_activity) {
+            fprintf(out, "\"syscalls\":%llu,\"io_chars\":%llu,\"run_ns\":%llu,\"wait_ns\":%llu,\"voluntary_switches\":%llu}\n",
+                    (unsigned long long)rec->syscalls, (unsigned long long)rec->io_chars,
+                    (unsigned long long)rec->run_ns, (unsigned long long)rec->wait_ns,
+                    (unsigned long long)rec->voluntary_switches);
+        } else {
+            fprintf(out, "\"syscalls\":null,\"io_chars\":null,\"run_ns\":null,\"wait_ns\":null,\"voluntary_switches\":null}\n");
+        }
+        return;
+    }
+
+    fprintf(out, "%lld,%d,%s,", (long long)rec->time_ns, (int)rec->cpu, reason);
+    if (rec->stopped_job >= 0) {
+        fprintf(out, "%d,%d,", (int)rec->stopped_job, (int)rec->stopped_pid);
+    } else {
+        fprintf(out, ",,");
+    }
+    if (rec->started_job >= 0) {
+        fprintf(out, "%d,%d,%lld,%s,", (int)rec->started_job, (int)rec->started_pid, (long long)rec->slice_us, type);
+    } else {
+        fprintf(out, ",,,,");
+    }
+    if (rec->cpu_ns >= 0) fprintf(out, "%lld", (long long)rec->cpu_ns);
+    if (rec->has_activity) {
+        fprintf(out, ",%llu,%llu,%llu,%llu,%llu\n",
+                (unsigned long long)rec->syscalls, (unsigned long long)rec->io_chars,
+                (unsigned long long)rec->run_ns, (unsigned long long)rec->wait_ns,
+                (unsigned long long)rec->voluntary_switches);
+    } else {
+        fprintf(out, ",,,,,\n");
+    }
+}
+
+//write out everything the MCP has pushed so far
+static void drain(void) {
+    uint64_t t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+    uint64_t h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    if (t == h) return;
+    for (; t != h; t++) {
+        write_record(&ring[t % TRACE_RING_SIZE]);
+    }
+    //the slots are free again once written
+    __atomic_store_n(&tail, t, __ATOMIC_RELEASE);
+    fflush(out);
+}
+
+static void *flush_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&flush_lock);
+        if (!stopping && !waiting_for_room) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_nsec += TRACE_FLUSH_MS * 1000000L;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+            deadline.tv_nsec %= 1000000000L;
+            pthread_cond_timedwait(&flush_cond, &flush_lock, &deadline);
+        }
+        int stop = stopping;
+        pthread_mutex_unlock(&flush_lock);
+
+        drain();
+        if (lossless) {
+            pthread_mutex_lock(&flush_lock);
+            pthread_cond_signal(&room_cond);
+            pthread_mutex_unlock(&flush_lock);
+        }
+        if (stop) break;
+    }
+    return NULL;
+}
+
+int trace_open(const char *path, int wait_when_full) {
+    out = fopen(path, "w");
+    if (out == NULL) return -1;
+    ring = malloc(TRACE_RING_SIZE * sizeof(trace_record));
+    if (ring == NULL) {
+        fclose(out);
+        out = NULL;
+        return -1;
+    }
+    lossless = wait_when_full;
+    as_json = ends_with(path, ".json") || ends_with(path, ".jsonl");
+    if (!as_json) {
+        fprintf(out, "time_ns,cpu,reason,stopped_job,stopped_pid,started_job,started_pid,slice_us,type,"
+                     "cpu_ns,syscalls,io_chars,run_ns,wait_ns,voluntary_switches\n");
+    }
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&flush_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    if (pthread_create(&flush_thread, NULL, flush_main, NULL) != 0) {
+        perror("Trace thread");
+        exit(1);
+    }
+    return 0;
+}
+
+int trace_enabled(void) {
+    return out != NULL;
+}
+
+void trace_push(const trace_record *rec) {
+    if (out == NULL) return;
+    uint64_t h = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    if (lossless && h - __atomic_load_n(&tail, __ATOMIC_ACQUIRE) == TRACE_RING_SIZE) {
+        //full: wake the flusher now instead of at its next tick, and sleep
+        //until it made room
+        pthread_mutex_lock(&flush_lock);
+        waiting_for_room = 1;
+        pthread_cond_signal(&flush_cond);
+        while (h - __atomic_load_n(&tail, __ATOMIC_ACQUIRE) == TRACE_RING_SIZE) {
+            pthread_cond_wait(&room_cond, &flush_lock);
+        }
+        waiting_for_room = 0;
+        pthread_mutex_unlock(&flush_lock);
+    }
+    if (h - __atomic_load_n(&tail, __ATOMIC_ACQUIRE) == TRACE_RING_SIZE) {
+        //the flusher is behind: lose this one rather than wait
+        dropped++;
+        return;
+    }
+    ring[h % TRACE_RING_SIZE] = *rec;
+    //publish the slot only after it is written
+    __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+}
+
+void trace_close(void) {
+    if (out == NULL) return;
+    pthread_mutex_lock(&flush_lock);
+    stopping = 1;
+    pthread_cond_signal(&flush_cond);
+    pthread_mutex_unlock(&flush_lock);
+    pthread_join(flush_thread, NULL);
+
+    if (dropped > 0) {
+        fprintf(stderr, "Trace: %llu records dropped (ring full)\n", (unsigned long long)dropped);
+    }
+    fclose(out);
+    out = NULL;
+    free(ring);
+    ring = NULL;
+}
@@ -0,0 +1,83 @@
+/*
+
+Scheduling timeline export (--trace <file>)
+    - one record per scheduling decision: when, on which core, which job
+      gave the core up and which got it, why, and the counters of the
+      outgoing job at that moment (CPU clock, /proc io/schedstat/status)
+    - the MCP pushes records into a single-producer single-consumer ring
+      in memory (two atomic indices, no lock, no syscall); a full ring
+      drops the record and counts it instead of making the MCP wait
+    - a flusher thread drains the ring every TRACE_FLUSH_MS and writes
+      the records out, so file I/O never happens in the scheduling path
+    - a simulation (virtual time, nothing real to keep running) opens it
+      with wait_when_full instead, so no record is ever lost: a full ring
+      wakes the flusher at once and the MCP sleeps until it made room
+    - a file ending in .json or .jsonl gets JSON Lines, anything else CSV
+      with a header line; unknown values are empty (CSV) or null (JSON)
+
+*/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+
+#define TRACE_RING_SIZE 8192
+#define TRACE_FLUSH_MS 100
+#define TRACE_TYPE_LEN 8
+
+//why a core changed hands
+//first pick of a core, or an idle core found work
+#define TRACE_START 1
+//the slice ran out
+#define TRACE_EXPIRY 2
+//the running job blocked before its slice ran out
+#define TRACE_BLOCK 3
+//the running job exited
+#define TRACE_EXIT 4
+
+// one scheduling decision
+typedef struct
+{
+    //ns since the MCP started (virtual time when simulating)
+    int64_t time_ns;
+    //CPU of the core
+    int32_t cpu;
+    //TRACE_START ... TRACE_EXIT
+    int32_t reason;
+    //job index (input file order) and pid that had the core, -1/0 if none
+    int32_t stopped_job;
+    int32_t stopped_pid;
+    //job that has the core now, -1/0 if the core went idle
+    int32_t started_job;
+    int32_t started_pid;
+    //slice the started job got, and the class the policy gave it
+    int64_t slice_us;
+    char type[TRACE_TYPE_LEN];
+    //stopped job: CPU clock (ns), -1 unknown
+    int64_t cpu_ns;
+    //stopped job: proc_activity counters, only if has_activity
+    int32_t has_activity;
+    uint64_t syscalls;
+    uint64_t io_chars;
+    uint64_t run_ns;
+    uint64_t wait_ns;
+    uint64_t voluntary_switches;
+}trace_record;
+
+//open path and start the flusher thread, returns 0 or -1 with errno set
+//wait_when_full: trace_push waits for the flusher instead of dropping
+int trace_open(const char *path, int wait_when_full);
+
+//1 between trace_open and trace_close
+int trace_enabled(void);
+
+//queue rec, never blocks unless wait_when_full (then it sleeps on a full
+//ring until the flusher drained it, else the record is dropped)
+void trace_push(const trace_record *rec);
+
+//stop the flusher, write whatever is left and close the file
+void trace_close(void);
+
+
+#endif /* TRACE_H_ */
@@ -8,6 +8,7 @@ EXECUTABLE1="part1"
 EXECUTABLE2="part2"
 EXECUTABLE3="part3"
 EXECUTABLE4="part4"
+PART5="raynap_proj2/part5"
 
 TEST_DIR="test_project2"
 INPUT_FILE="input.txt"
@@ -350,6 +351,333 @@ Process: - Finished."
     cleanup_test_environment
 }
 
+test_part5_blocked() {
+
+    echo "=== Testing if part5 leaves blocked jobs alone... ==="
+
+    if [ ! -f "$PART5" ]; then
+        echo "Error: Compilation failed, $PART5 executable not found."
+        return
+    fi
+
+    # two jobs that mostly sleep, two that only compute: a job that
+    # blocked must never get the core straight back while others can run
+    printf 'cpu:1 io:10 x30\ncpu:2 io:5 x40\ncpu:200\ncpu:200\n' > blocked_workload.txt
+
+    for policy in heuristic rr mlfq cfs dag stride lottery; do
+        ./$PART5 --simulate blocked_workload.txt -q 20 -p $policy --trace blocked_trace.csv > /dev/null 2>&1
+        # trace columns: time_ns,cpu,reason,stopped_job,stopped_pid,started_job,...
+        result=$(awk -F, '$3 == "block" { blocks++; if ($4 == $6) repicked++ }
+                          END { print blocks + 0, repicked + 0 }' blocked_trace.csv)
+        blocks=${result% *}
+        repicked=${result#* }
+
+        if [ "$blocks" -eq 0 ]; then
+            echo "Error: -p $policy: no job was seen blocking"
+        elif [ "$repicked" -ne 0 ]; then
+            echo "Error: -p $policy: $repicked of $blocks blocked jobs were picked again right away"
+        else
+            echo "Success: -p $policy: none of $blocks blocked jobs was picked again right away"
+        fi
+    done
+
+    rm -f blocked_workload.txt blocked_trace.csv
+    echo ""
+}
+
+test_part5_cfs() {
+
+    echo "=== Testing if part5's cfs shares the CPU by weight... ==="
+
+    if [ ! -f "$PART5" ]; then
+        echo "Error: Compilation failed, $PART5 executable not found."
+        return
+    fi
+
+    # weights 3072, 1024 and nice:5 (335) should get about 9:3:1 of one core
+    printf 'weight:3072 cpu:3000\ncpu:3000\nnice:5 cpu:3000\n' > cfs_workload.txt
+    ./$PART5 --simulate cfs_workload.txt -j 1 -q 20 -p cfs --trace cfs_trace.csv > /dev/null 2>&1
+
+    # each record's started job has the core until the next record,
+    # counted until the first job exits (all three compete until then)
+    result=$(awk -F, 'NR > 1 { if (job != "") ran[job] += $1 - t; if ($3 == "exit") exit; job = $6; t = $1 }
+                      END { if (ran[2] > 0) printf "%.2f %.2f", ran[0] / ran[2], ran[1] / ran[2]; else print "0 0" }' cfs_trace.csv)
+    heavy=${result% *}
+    normal=${result#* }
+
+    if awk -v h="$heavy" -v n="$normal" 'BEGIN { exit !(h > 8.1 && h < 9.9 && n > 2.7 && n < 3.3) }'; then
+        echo "Success: cfs shares were $heavy:$normal:1 (expected about 9:3:1)"
+    else
+        echo "Error: cfs shares were $heavy:$normal:1, expected about 9:3:1"
+    fi
+
+    rm -f cfs_workload.txt cfs_trace.csv
+    echo ""
+}
+
+test_part5_tickets() {
+
+    echo "=== Testing if part5's stride and lottery share the CPU by tickets... ==="
+
+    if [ ! -f "$PART5" ]; then
+        echo "Error: Compilation failed, $PART5 executable not found."
+        return
+    fi
+
+    # 300, 200 and 100 tickets: 3:2:1 of one core, exactly for stride,
+    # roughly for lottery (a simulation always seeds it the same way)
+    printf 'tickets:300 cpu:30000\ntickets:200 cpu:30000\ntickets:100 cpu:30000\n' > tickets_workload.txt
+
+    for policy in stride lottery; do
+        ./$PART5 --simulate tickets_workload.txt -j 1 -q 20 -p $policy --trace tickets_trace.csv > /dev/null 2>&1
+        # ms each job had the core until the first one exits
+        result=$(awk -F, 'NR > 1 { if (job != "") ran[job] += $1 - t; if ($3 == "exit") exit; job = $6; t = $1 }
+                          END { printf "%d %d %d", ran[0] / 1e6, ran[1] / 1e6, ran[2] / 1e6 }' tickets_trace.csv)
+        read first second third <<< "$result"
+
+        if [ "$policy" = "stride" ]; then
+            # off by at most one quantum
+            fits=$(awk -v a=$first -v b=$second -v c=$third 'BEGIN { d1 = a - 3 * c; d2 = b - 2 * c;
+                       print (c > 0 && d1 <= 60 && d1 >= -60 && d2 <= 60 && d2 >= -60) }')
+        else
+            # each job within 5% of the whole of its share
+            fits=$(awk -v a=$first -v b=$second -v c=$third 'BEGIN { t = a + b + c;
+                       print (t > 0 && a / t - 0.5 < 0.05 && 0.5 - a / t < 0.05 && b / t - 1 / 3 < 0.05 &&
+                              1 / 3 - b / t < 0.05 && c / t - 1 / 6 < 0.05 && 1 / 6 - c / t < 0.05) }')
+        fi
+
+        if [ "$fits" -eq 1 ]; then
+            echo "Success: -p $policy: jobs had the core for $first:$second:$third ms (expected about 3:2:1)"
+        else
+            echo "Error: -p $policy: jobs had the core for $first:$second:$third ms, expected about 3:2:1"
+        fi
+    done
+
+    # same seed, same draws
+    ./$PART5 --simulate tickets_workload.txt -j 1 -q 20 -p lottery --trace tickets_trace2.csv > /dev/null 2>&1
+    if cmp -s tickets_trace.csv tickets_trace2.csv; then
+        echo "Success: -p lottery: two simulations drew the same tickets"
+    else
+        echo "Error: -p lottery: two simulations drew different tickets"
+    fi
+
+    rm -f tickets_workload.txt tickets_trace.csv tickets_trace2.csv
+    echo ""
+}
+
+test_part5_dag() {
+
+    echo "=== Testing if part5 runs a job only after the jobs it is after:... ==="
+
+    if [ ! -f "$PART5" ]; then
+        echo "Error: Compilation failed, $PART5 executable not found."
+        return
+    fi
+
+    # three cores: job 3 could start at once, but it is after jobs 1 and 2
+    printf 'cpu:100\ncpu:300\ncpu:200\nafter:1,2 cpu:50\n' > dag_workload.txt
+    ./$PART5 --simulate dag_workload.txt -j 3 -q 20 -p dag > dag_output.txt 2>&1
+
+    # report columns: Job Arrival CPU Response Wait Turnaround (all arrive at 0)
+    result=$(awk '$1 ~ /^[0-9]+$/ { response[$1] = $4; finish[$1] = $2 + $6 }
+                  END { last = finish[1] > finish[2] ? finish[1] : finish[2];
+                        print (3 in finish && response[3] >= last && finish[3] > last) }' dag_output.txt)
+    if [ "$result" -eq 1 ]; then
+        echo "Success: job 3 started and finished after jobs 1 and 2"
+    else
+        echo "Error: job 3 did not wait for jobs 1 and 2"
+    fi
+
+    # a failed job (live run, a script cannot fail): the jobs after it,
+    # and the ones after those, never run; job 3 does not care
+    printf 'false\nafter:0 true\nafter:1 true\ntrue\n' > dag_workload.txt
+    ./$PART5 -f dag_workload.txt -j 1 -q 20 -p dag > dag_output.txt 2>&1
+
+    if grep -q "Job 1 not run: job 0 failed" dag_output.txt && grep -q "Job 2 not run: job 1 failed" dag_output.txt &&
+       ! grep -Eq "^(1|2) " dag_output.txt && grep -Eq "^3 " dag_output.txt; then
+        echo "Success: a failed job cancelled the jobs after it, and only those"
+    else
+        echo "Error: a failed job did not cancel exactly the jobs after it"
+    fi
+
+    rm -f dag_workload.txt dag_output.txt
+    echo ""
+}
+
+test_part5_arrivals() {
+
+    echo "=== Testing if part5 admits at:<ms> jobs when they arrive... ==="
+
+    if [ ! -f "$PART5" ]; then
+        echo "Error: Compilation failed, $PART5 executable not found."
+        return
+    fi
+
+    # job 1 arrives 300 ms in, while job 0 holds the only core
+    printf 'cpu:1000\nat:300 cpu:100\n' > arrival_workload.txt
+    ./$PART5 --simulate arrival_workload.txt -j 1 -q 20 -p rr --trace arrival_trace.csv > arrival_output.txt 2>&1
+
+    # first time job 1 got the core (trace), and its response (report
+    # columns: Job Arrival CPU Response Wait Turnaround)
+    started=$(awk -F, '$6 == 1 { print int($1 / 1e6); exit }' arrival_trace.csv)
+    response=$(awk '$1 == 1 { print int($4) }' arrival_output.txt)
+
+    if [ -z "$started" ] || [ "$started" -lt 300 ]; then
+        echo "Error: job 1 ran before it arrived (at ${started:-no} ms)"
+    else
+        echo "Success: job 1 first ran at $started ms, after it arrived at 300 ms"
+    fi
+    # one quantum at most, not the 300 ms it was not there for
+    if [ -n "$response" ] && [ "$response" -le 20 ]; then
+        echo "Success: job 1's response ($response ms) was counted from its arrival"
+    else
+        echo "Error: job 1's response (${response:-no} ms) was not counted from its arrival"
+    fi
+
+    rm -f arrival_workload.txt arrival_trace.csv arrival_output.txt
+    echo ""
+}
+
+test_part5_max_active() {
+
+    echo "=== Testing if part5 keeps at most --max-active jobs alive... ==="
+
+    if [ ! -f "$PART5" ]; then
+        echo "Error: Compilation failed, $PART5 executable not found."
+        return
+    fi
+
+    # six jobs, three cores, room for two jobs at a time
+    for i in 1 2 3 4 5 6; do echo "cpu:100 io:50 cpu:100"; done > active_workload.txt
+    for i in 1 2 3 4 5 6; do echo "sleep 0.2"; done > active_jobs.txt
+
+    for mode in simulate live; do
+        if [ "$mode" = "simulate" ]; then
+            ./$PART5 --simulate active_workload.txt -j 3 -q 20 -p rr --max-active 2 > active_output.txt 2>&1
+            # Job Arrival CPU Response Wait Turnaround
+            columns='start = $2 + $4; finish = $2 + $6'
+        else
+            ./$PART5 -f active_jobs.txt -j 3 -q 20 -p rr --max-active 2 > active_output.txt 2>&1
+            # Job Arrival CPU Response Turnaround
+            columns='start = $2 + $4; finish = $2 + $5'
+        fi
+
+        # a job is alive from its first slice to its exit: the most jobs
+        # alive at once is the most intervals holding some job's start
+        result=$(awk "\$1 ~ /^[0-9]+\$/ { $columns; s[n] = start; f[n++] = finish }"'
+                      END { for (i = 0; i < n; i++) { alive = 0
+                                for (j = 0; j < n; j++) if (s[j] <= s[i] && s[i] < f[j]) alive++
+                                if (alive > most) most = alive }
+                            print n + 0, most + 0 }' active_output.txt)
+        finished=${result% *}
+        most=${result#* }
+
+        if [ "$finished" -ne 6 ]; then
+            echo "Error: $mode: $finished of 6 jobs finished"
+        elif [ "$most" -gt 2 ]; then
+            echo "Error: $mode: $most jobs were alive at once with --max-active 2"
+        else
+            echo "Success: $mode: at most $most jobs were alive at once with --max-active 2"
+        fi
+    done
+
+    rm -f active_workload.txt active_jobs.txt active_output.txt
+    echo ""
+}
+
+test_part5_mlfq() {
+
+    echo "=== Testing if part5's mlfq moves jobs between levels... ==="
+
+    if [ ! -f "$PART5" ]; then
+        echo "Error: Compilation failed, $PART5 executable not found."
+        return
+    fi
+
+    # alone on the core: 200 ms of CPU sinks it, short bursts between
+    # I/O bring it back up
+    printf 'cpu:200 io:10 cpu:1 io:10 cpu:1 io:10 cpu:1 io:10 cpu:1\n' > mlfq_workload.txt
+    ./$PART5 --simulate mlfq_workload.txt -j 1 -q 20 -p mlfq --trace mlfq_trace.csv > /dev/null 2>&1
+
+    # trace columns: time_ns,cpu,reason,stopped_job,stopped_pid,started_job,
+    # started_pid,slice_us,type ("Level k"); a slice at level k is 20 ms << k
+    result=$(awk -F, 'NR > 1 && $6 != "" { level = substr($9, 7) + 0
+                          if ($8 != 20000 * 2 ^ level) wrong++
+                          if (last != "" && $3 == "expiry") { if (level == last + 1) down++; else if (level != 3) wrong++ }
+                          if (last != "" && blocked) { if (level == last - 1) up++; else if (level != 0) wrong++ }
+                          last = level }
+                      { blocked = $3 == "block" }
+                      END { print down + 0, up + 0, wrong + 0 }' mlfq_trace.csv)
+    read down up wrong <<< "$result"
+
+    if [ "$wrong" -ne 0 ]; then
+        echo "Error: $wrong slices were at the wrong level or length"
+    elif [ "$down" -ne 3 ] || [ "$up" -ne 3 ]; then
+        echo "Error: the job moved down $down and up $up levels, expected 3 and 3"
+    else
+        echo "Success: the job moved down a level per used-up slice and up one per early block"
+    fi
+
+    # two jobs that only compute sink to level 3, until the boost after
+    # 32 quanta (640 ms) puts them back on level 0
+    printf 'cpu:1500\ncpu:1500\n' > mlfq_workload.txt
+    ./$PART5 --simulate mlfq_workload.txt -j 1 -q 20 -p mlfq --trace mlfq_trace.csv > /dev/null 2>&1
+
+    boosted=$(awk -F, 'NR > 1 && $6 != "" { if ($9 == "Level 3") sunk = 1
+                           else if ($9 == "Level 0" && sunk && $1 >= 640000000) { print int($1 / 1e6); exit } }' mlfq_trace.csv)
+    if [ -n "$boosted" ]; then
+        echo "Success: jobs on level 3 were boosted back to level 0 at $boosted ms"
+    else
+        echo "Error: jobs on level 3 were never boosted back to level 0"
+    fi
+
+    rm -f mlfq_workload.txt mlfq_trace.csv
+    echo ""
+}
+
+test_part5_trace() {
+
+    echo "=== Testing part5's --trace CSV and JSONL files... ==="
+
+    if [ ! -f "$PART5" ]; then
+        echo "Error: Compilation failed, $PART5 executable not found."
+        return
+    fi
+
+    # two 100 ms jobs, 20 ms slices: a start, 8 expiries and 2 exits
+    printf 'cpu:100\ncpu:100\n' > trace_workload.txt
+    ./$PART5 --simulate trace_workload.txt -j 1 -q 20 -p rr --trace trace_test.csv > /dev/null 2>&1
+    ./$PART5 --simulate trace_workload.txt -j 1 -q 20 -p rr --trace trace_test.jsonl > /dev/null 2>&1
+
+    columns="time_ns,cpu,reason,stopped_job,stopped_pid,started_job,started_pid,slice_us,type,cpu_ns,syscalls,io_chars,run_ns,wait_ns,voluntary_switches"
+    if [ "$(head -n 1 trace_test.csv)" = "$columns" ] &&
+       awk -F, 'NR > 1 && NF != 15 { exit 1 }' trace_test.csv; then
+        echo "Success: the CSV trace has the expected columns"
+    else
+        echo "Error: the CSV trace does not have the expected columns"
+    fi
+
+    # the keys of every JSONL record, in order, are the CSV columns
+    keys=$(sed 's/"\([a-z_]*\)":[^,}]*[,}]/\1,/g; s/^{//; s/,$//' trace_test.jsonl | sort -u)
+    if [ "$keys" = "$columns" ]; then
+        echo "Success: every JSONL record has the expected keys"
+    else
+        echo "Error: JSONL records do not have the expected keys"
+    fi
+
+    csv_records=$(tail -n +2 trace_test.csv | awk -F, '{ print $1, $3 }' | tr '\n' ' ')
+    json_records=$(sed 's/.*"time_ns":\([0-9]*\),.*"reason":"\([a-z]*\)".*/\1 \2/' trace_test.jsonl | tr '\n' ' ')
+    switches=$(tail -n +2 trace_test.csv | wc -l)
+    if [ "$switches" -eq 11 ] && [ "$csv_records" = "$json_records" ]; then
+        echo "Success: both traces have one record per switch ($switches)"
+    else
+        echo "Error: expected 11 records in both traces, CSV has $switches"
+    fi
+
+    rm -f trace_workload.txt trace_test.csv trace_test.jsonl
+    echo ""
+}
+
 #------------------------------------
 
 make clean
@@ -358,6 +686,7 @@ rm -drf $TEST_DIR
 make
 gcc iobound.c -o iobound
 gcc cpubound.c -o cpubound
+make -C raynap_proj2 part5
 
 echo ""
 
@@ -369,4 +698,12 @@ test_part1 $EXECUTABLE1
 test_part2 $EXECUTABLE2
 test_part3 $EXECUTABLE3
 test_part4 $EXECUTABLE4
+test_part5_blocked
+test_part5_cfs
+test_part5_tickets
+test_part5_dag
+test_part5_arrivals
+test_part5_max_active
+test_part5_mlfq
+test_part5_trace
 